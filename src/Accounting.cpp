@@ -0,0 +1,66 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <Accounting.h>
+
+Accounting accounting;
+
+////////////////////////////////////////////////////////////////////////////////
+// The time taken to spawn the child, and its lifetime, in seconds.
+void Accounting::record (
+  const std::string& name,
+  double spawn,
+  double elapsed,
+  const struct rusage& usage)
+{
+  std::lock_guard <std::mutex> lock (_mutex);
+
+  auto& command = _commands[name];
+  command.latencies.push_back (elapsed);
+  command.spawn  += spawn;
+  command.user   += usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1000000.0;
+  command.system += usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1000000.0;
+
+  // Linux reports kilobytes, macOS bytes.
+#ifdef DARWIN
+  long rss = usage.ru_maxrss / 1024;
+#else
+  long rss = usage.ru_maxrss;
+#endif
+  if (rss > command.maxRSS)
+    command.maxRSS = rss;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::map <std::string, Accounting::Command> Accounting::commands () const
+{
+  std::lock_guard <std::mutex> lock (_mutex);
+  return _commands;
+}
+
+////////////////////////////////////////////////////////////////////////////////
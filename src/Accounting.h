@@ -0,0 +1,63 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_ACCOUNTING
+#define INCLUDED_ACCOUNTING
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <sys/resource.h>
+
+// Wall time, CPU time and memory of every child process, by command name.
+// Children may be reaped on any thread.
+class Accounting
+{
+public:
+  struct Command
+  {
+    std::vector <double> latencies {};
+    double               spawn     {0.0};
+    double               user      {0.0};
+    double               system    {0.0};
+    long                 maxRSS    {0};
+  };
+
+  void record (const std::string&, double, double, const struct rusage&);
+  std::map <std::string, Command> commands () const;
+
+private:
+  mutable std::mutex              _mutex    {};
+  std::map <std::string, Command> _commands {};
+};
+
+extern Accounting accounting;
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
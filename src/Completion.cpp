@@ -0,0 +1,235 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <Completion.h>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <shared.h>
+#include <Executor.h>
+#include <Watcher.h>
+
+#ifdef HAVE_READLINE
+#include <readline/readline.h>
+#endif
+
+Completion completion;
+
+// tasksh commands, which Taskwarrior does not know about.
+static std::vector <std::string> builtins = {
+  "diagnostics",
+  "exec",
+  "exit",
+  "help",
+  "quit",
+  "review",
+  "stats",
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// The matches for the word being completed, in sorted order.
+static std::vector <std::string> matches;
+
+////////////////////////////////////////////////////////////////////////////////
+#ifdef HAVE_READLINE
+static char* generate (const char*, int state)
+{
+  static size_t next;
+  if (state == 0)
+    next = 0;
+
+  if (next < matches.size ())
+    return strdup (matches[next++].c_str ());
+
+  return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static char** attempt (const char* text, int start, int)
+{
+  // Never fall back to file name completion.
+  rl_attempted_completion_over = 1;
+
+  // The first word is a command.
+  bool first = true;
+  for (int i = 0; i < start; ++i)
+    if (rl_line_buffer[i] != ' ' && rl_line_buffer[i] != '\t')
+      first = false;
+
+  matches = completion.complete (text, first);
+  if (matches.size () == 0)
+    return nullptr;
+
+  return rl_completion_matches (text, generate);
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+void Completion::install ()
+{
+#ifdef HAVE_READLINE
+  // Words include the characters of attribute names and tags, so that
+  // 'project:Ho' and '+ho' are completed as a whole.
+  static char breaks[] = " \t\n\"'";
+  rl_completer_word_break_characters = breaks;
+  rl_attempted_completion_function = attempt;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Commands are completed at the start of the line, projects after
+// 'project:' (or an abbreviation of it), tags after '+' or '-', and UUIDs for
+// any other word of at least two hex digits.  A word of decimal digits is an
+// ID, and is left alone.
+std::vector <std::string> Completion::complete (const std::string& word, bool first)
+{
+  std::string prefix;
+  std::string lead;
+  std::vector <std::string> sources;
+
+  if (first)
+  {
+    sources = {"_commands", "_aliases", "builtins"};
+    prefix = word;
+  }
+  else if (word.length () && (word[0] == '+' || word[0] == '-'))
+  {
+    sources = {"_tags"};
+    lead = word.substr (0, 1);
+    prefix = word.substr (1);
+  }
+  else if (word.find (':') != std::string::npos)
+  {
+    auto colon = word.find (':');
+    if (! closeEnough ("project", word.substr (0, colon), 3))
+      return {};
+
+    sources = {"_projects"};
+    lead = word.substr (0, colon + 1);
+    prefix = word.substr (colon + 1);
+  }
+  else if (word.length () >= 2                                                &&
+           word.find_first_not_of ("0123456789") != std::string::npos          &&
+           word.find_first_not_of ("0123456789abcdefABCDEF-") == std::string::npos)
+  {
+    // UUIDs are kept packed, and only formatted when they match.  They are
+    // lower case, but Taskwarrior accepts either.
+    std::vector <std::string> results;
+    auto lower = lowerCase (word);
+    Uuid floor;
+    if (Uuid::floor (lower, floor))
+    {
+      auto& items = uuids ();
+      for (auto i = std::lower_bound (items.begin (), items.end (), floor);
+           i != items.end () && i->startsWith (lower);
+           ++i)
+        results.push_back (i->str ());
+    }
+
+    return results;
+  }
+  else
+    return {};
+
+  std::vector <std::string> results;
+  for (auto& source : sources)
+  {
+    auto& items = list (source);
+    for (auto i = std::lower_bound (items.begin (), items.end (), prefix);
+         i != items.end () && i->compare (0, prefix.length (), prefix) == 0;
+         ++i)
+      results.push_back (lead + *i);
+  }
+
+  std::sort (results.begin (), results.end ());
+  results.erase (std::unique (results.begin (), results.end ()), results.end ());
+  return results;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const std::vector <std::string>& Completion::list (const std::string& helper)
+{
+  // Commands and aliases depend on the configuration, everything else on the
+  // data.
+  bool commands = helper == "_commands" || helper == "_aliases" || helper == "builtins";
+  auto generation = commands ? watcher.configGeneration () : watcher.dataGeneration ();
+
+  auto found = _lists.find (helper);
+  if (found != _lists.end () &&
+      found->second.generation == generation)
+    return found->second.items;
+
+  auto& entry = _lists[helper];
+  entry.generation = generation;
+  entry.items.clear ();
+
+  if (helper == "builtins")
+  {
+    entry.items = builtins;
+  }
+  else
+  {
+    // The helpers are run without garbage collection or recurrence, so that
+    // they do not modify the data, and invalidate the list just loaded.
+    std::string output;
+    executor ().capture ("task", {"rc.verbose=nothing", "rc.gc=off", "rc.recurrence=off", "rc.hooks=off", helper}, output);
+    for (auto& line : split (output, '\n'))
+      if (line != "")
+        entry.items.push_back (line);
+  }
+
+  std::sort (entry.items.begin (), entry.items.end ());
+  return entry.items;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const std::vector <Uuid>& Completion::uuids ()
+{
+  auto generation = watcher.dataGeneration ();
+  if (_uuidsLoaded && _uuidGeneration == generation)
+    return _uuids;
+
+  _uuidsLoaded = true;
+  _uuidGeneration = generation;
+  _uuids.clear ();
+
+  Uuid uuid;
+  executor ().stream ("task", {"rc.verbose=nothing", "rc.gc=off", "rc.recurrence=off", "rc.hooks=off", "_uuids"},
+                      [this, &uuid] (const std::string& line)
+                      {
+                        if (Uuid::parse (line, uuid))
+                          _uuids.push_back (uuid);
+
+                        return true;
+                      });
+
+  std::sort (_uuids.begin (), _uuids.end ());
+  return _uuids;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,67 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_COMPLETION
+#define INCLUDED_COMPLETION
+
+#include <string>
+#include <vector>
+#include <map>
+#include <Uuid.h>
+
+// Tab completion of commands, projects, tags and UUIDs.  Each list is loaded
+// from Taskwarrior the first time it is needed, kept sorted for prefix
+// lookup, and loaded again only after the data files (or, for commands, the
+// configuration) have changed.
+class Completion
+{
+public:
+  void install ();
+  std::vector <std::string> complete (const std::string&, bool);
+
+private:
+  const std::vector <std::string>& list (const std::string&);
+  const std::vector <Uuid>& uuids ();
+
+private:
+  struct List
+  {
+    unsigned long              generation;
+    std::vector <std::string>  items;
+  };
+
+  std::map <std::string, List> _lists          {};
+  std::vector <Uuid>           _uuids          {};
+  unsigned long                _uuidGeneration {0};
+  bool                         _uuidsLoaded    {false};
+};
+
+extern Completion completion;
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
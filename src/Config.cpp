@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <Config.h>
+#include <cstdlib>
+#include <Watcher.h>
+#include <Executor.h>
+#include <shared.h>
+
+Config config;
+
+////////////////////////////////////////////////////////////////////////////////
+bool Config::has (const std::string& name)
+{
+  refresh ();
+  return _data.find (name) != _data.end ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string Config::get (const std::string& name)
+{
+  refresh ();
+  auto i = _data.find (name);
+  if (i != _data.end ())
+    return i->second;
+
+  return "";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Follows Taskwarrior's interpretation of Boolean values.
+bool Config::getBoolean (const std::string& name)
+{
+  auto value = lowerCase (get (name));
+  return value == "true" ||
+         value == "1"    ||
+         value == "y"    ||
+         value == "yes"  ||
+         value == "on";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int Config::getInteger (const std::string& name, int defaultValue)
+{
+  auto value = get (name);
+  if (value == "")
+    return defaultValue;
+
+  return strtol (value.c_str (), NULL, 10);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Permanently changes the setting in .taskrc, and in the snapshot, which then
+// does not need to be reloaded.
+void Config::set (const std::string& name, const std::string& value)
+{
+  std::string output;
+  executor ().capture ("task", {"rc.confirmation:no", "rc.verbose:nothing", "config", name, value}, output);
+
+  refresh ();
+  _data[name] = value;
+  _generation = watcher.configGeneration ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Config::invalidate ()
+{
+  _loaded = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Same rules as Taskwarrior: $TASKRC, or ~/.taskrc.
+std::string Config::file () const
+{
+  auto env = getenv ("TASKRC");
+  if (env)
+    return env;
+
+  env = getenv ("HOME");
+  return std::string (env ? env : "") + "/.taskrc";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Same rules as Taskwarrior: $TASKDATA, or rc.data.location.
+std::string Config::dataLocation ()
+{
+  auto env = getenv ("TASKDATA");
+  std::string location = env ? env : get ("data.location");
+  if (location == "")
+    location = "~/.task";
+
+  if (location[0] == '~')
+  {
+    env = getenv ("HOME");
+    location = std::string (env ? env : "") + location.substr (1);
+  }
+
+  return location;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Config::refresh ()
+{
+  auto generation = watcher.configGeneration ();
+  if (_loaded && generation == _generation)
+    return;
+
+  // 'task _show' lists every setting, including defaults, as 'name=value'.
+  std::string output;
+  executor ().capture ("task", {"_show"}, output);
+
+  _data.clear ();
+  for (auto& line : split (output, '\n'))
+  {
+    auto equals = line.find ('=');
+    if (equals != std::string::npos)
+      _data[line.substr (0, equals)] = line.substr (equals + 1);
+  }
+
+  _loaded = true;
+  _generation = generation;
+}
+
+////////////////////////////////////////////////////////////////////////////////
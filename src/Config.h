@@ -0,0 +1,63 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_CONFIG
+#define INCLUDED_CONFIG
+
+#include <map>
+#include <string>
+
+// A snapshot of the Taskwarrior configuration, obtained with a single
+// 'task _show', and reloaded whenever the Watcher reports a .taskrc change.
+class Config
+{
+public:
+  Config () = default;
+
+  bool has (const std::string&);
+  std::string get (const std::string&);
+  bool getBoolean (const std::string&);
+  int getInteger (const std::string&, int);
+  void set (const std::string&, const std::string&);
+  void invalidate ();
+  std::string file () const;
+  std::string dataLocation ();
+
+private:
+  void refresh ();
+
+private:
+  std::map <std::string, std::string> _data       {};
+  bool                                _loaded     {false};
+  unsigned long                       _generation {0};
+};
+
+extern Config config;
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
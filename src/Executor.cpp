@@ -0,0 +1,488 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <Executor.h>
+#include <iostream>
+#include <thread>
+#include <process.h>
+#include <JSON.h>
+#include <format.h>
+
+// Static initialization happens on the main thread.
+static const std::thread::id mainThread = std::this_thread::get_id ();
+
+////////////////////////////////////////////////////////////////////////////////
+int SpawnExecutor::run (
+  const std::string& exe,
+  const std::vector <std::string>& args)
+{
+  return spawn (exe, args);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int SpawnExecutor::runPty (
+  const std::string& exe,
+  const std::vector <std::string>& args,
+  unsigned short width,
+  unsigned short height,
+  std::string& output,
+  std::string::size_type limit)
+{
+  return spawnPty (exe, args, width, height, output, limit);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int SpawnExecutor::capture (
+  const std::string& exe,
+  const std::vector <std::string>& args,
+  std::string& output,
+  int timeout)
+{
+  return ::capture (exe, args, output, timeout);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int SpawnExecutor::collect (
+  const std::string& exe,
+  const std::vector <std::string>& args,
+  std::string& output,
+  std::string& errors)
+{
+  return ::collect (exe, args, output, errors);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int SpawnExecutor::stream (
+  const std::string& exe,
+  const std::vector <std::string>& args,
+  std::function <bool (const std::string&)> handler)
+{
+  return ::stream (exe, args, handler);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+PoolExecutor::PoolExecutor (std::unique_ptr <Executor> inner, unsigned int limit)
+: _inner (std::move (inner))
+, _limit (limit ? limit : 1)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int PoolExecutor::run (
+  const std::string& exe,
+  const std::vector <std::string>& args)
+{
+  return _inner->run (exe, args);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int PoolExecutor::runPty (
+  const std::string& exe,
+  const std::vector <std::string>& args,
+  unsigned short width,
+  unsigned short height,
+  std::string& output,
+  std::string::size_type limit)
+{
+  return _inner->runPty (exe, args, width, height, output, limit);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int PoolExecutor::capture (
+  const std::string& exe,
+  const std::vector <std::string>& args,
+  std::string& output,
+  int timeout)
+{
+  auto limited = acquire ();
+  auto status = _inner->capture (exe, args, output, timeout);
+  if (limited)
+    release ();
+
+  return status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int PoolExecutor::collect (
+  const std::string& exe,
+  const std::vector <std::string>& args,
+  std::string& output,
+  std::string& errors)
+{
+  auto limited = acquire ();
+  auto status = _inner->collect (exe, args, output, errors);
+  if (limited)
+    release ();
+
+  return status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int PoolExecutor::stream (
+  const std::string& exe,
+  const std::vector <std::string>& args,
+  std::function <bool (const std::string&)> handler)
+{
+  auto limited = acquire ();
+  auto status = _inner->stream (exe, args, handler);
+  if (limited)
+    release ();
+
+  return status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Returns whether a place was taken, to be released.
+bool PoolExecutor::acquire ()
+{
+  if (std::this_thread::get_id () == mainThread)
+    return false;
+
+  std::unique_lock <std::mutex> lock (_mutex);
+  _free.wait (lock, [this] { return _running < _limit; });
+  ++_running;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PoolExecutor::release ()
+{
+  {
+    std::lock_guard <std::mutex> lock (_mutex);
+    --_running;
+  }
+
+  _free.notify_one ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+RecordExecutor::RecordExecutor (std::unique_ptr <Executor> inner, const std::string& file)
+: _inner (std::move (inner))
+, _file (file, std::ios::app)
+{
+  if (! _file.good ())
+    throw format ("Could not write '{1}'.", file);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Output shown at the terminal is not seen, so only the status is recorded.
+int RecordExecutor::run (
+  const std::string& exe,
+  const std::vector <std::string>& args)
+{
+  auto status = _inner->run (exe, args);
+  record (exe, args, status, "", "");
+  return status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int RecordExecutor::runPty (
+  const std::string& exe,
+  const std::vector <std::string>& args,
+  unsigned short width,
+  unsigned short height,
+  std::string& output,
+  std::string::size_type limit)
+{
+  auto status = _inner->runPty (exe, args, width, height, output, limit);
+  record (exe, args, status, output, "");
+  return status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int RecordExecutor::capture (
+  const std::string& exe,
+  const std::vector <std::string>& args,
+  std::string& output,
+  int timeout)
+{
+  auto status = _inner->capture (exe, args, output, timeout);
+  record (exe, args, status, output, "");
+  return status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int RecordExecutor::collect (
+  const std::string& exe,
+  const std::vector <std::string>& args,
+  std::string& output,
+  std::string& errors)
+{
+  auto status = _inner->collect (exe, args, output, errors);
+  record (exe, args, status, output, errors);
+  return status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Only the lines that were read are recorded.
+int RecordExecutor::stream (
+  const std::string& exe,
+  const std::vector <std::string>& args,
+  std::function <bool (const std::string&)> handler)
+{
+  if (exe != "task")
+    return _inner->stream (exe, args, handler);
+
+  std::string output;
+  auto status = _inner->stream (exe, args, [&output, &handler] (const std::string& line)
+  {
+    output += line + '\n';
+    return handler (line);
+  });
+
+  record (exe, args, status, output, "");
+  return status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RecordExecutor::record (
+  const std::string& exe,
+  const std::vector <std::string>& args,
+  int status,
+  const std::string& output,
+  const std::string& errors)
+{
+  if (exe != "task")
+    return;
+
+  std::string line = "{\"args\":[";
+  for (unsigned int i = 0; i < args.size (); ++i)
+  {
+    if (i)
+      line += ',';
+
+    line += '"' + json::encode (args[i]) + '"';
+  }
+
+  line += format ("],\"status\":{1},\"output\":\"", status)
+        + json::encode (output)
+        + "\",\"errors\":\""
+        + json::encode (errors)
+        + "\"}\n";
+
+  std::lock_guard <std::mutex> lock (_mutex);
+  _file << line << std::flush;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static std::string replayKey (const std::vector <std::string>& args)
+{
+  std::string key;
+  for (auto& arg : args)
+    key += arg + '\x1f';
+
+  return key;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static std::string replayString (json::object* object, const std::string& name)
+{
+  auto field = object->_data.find (name);
+  if (field != object->_data.end () &&
+      field->second->type () == json::j_string)
+    return json::decode (((json::string*) field->second)->_data);
+
+  return "";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ReplayExecutor::ReplayExecutor (std::unique_ptr <Executor> inner, const std::string& file)
+: _inner (std::move (inner))
+{
+  std::ifstream in (file);
+  if (! in.good ())
+    throw format ("Could not read '{1}'.", file);
+
+  std::string line;
+  while (std::getline (in, line))
+  {
+    if (line == "")
+      continue;
+
+    std::unique_ptr <json::value> root (json::parse (line));
+    if (! root || root->type () != json::j_object)
+      continue;
+
+    auto object = (json::object*) root.get ();
+    auto args   = object->_data.find ("args");
+    auto status = object->_data.find ("status");
+    if (args   == object->_data.end () || args->second->type ()   != json::j_array ||
+        status == object->_data.end () || status->second->type () != json::j_number)
+      continue;
+
+    std::vector <std::string> words;
+    for (auto& arg : ((json::array*) args->second)->_data)
+      if (arg->type () == json::j_string)
+        words.push_back (json::decode (((json::string*) arg)->_data));
+
+    _answers[replayKey (words)].push_back ({(int) ((json::number*) status->second)->_dvalue,
+                                            replayString (object, "output"),
+                                            replayString (object, "errors")});
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ReplayExecutor::run (
+  const std::string& exe,
+  const std::vector <std::string>& args)
+{
+  if (exe != "task")
+    return _inner->run (exe, args);
+
+  auto reply = answer (args);
+  std::cout << reply.output << std::flush;
+  std::cerr << reply.errors << std::flush;
+  return reply.status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ReplayExecutor::runPty (
+  const std::string& exe,
+  const std::vector <std::string>& args,
+  unsigned short width,
+  unsigned short height,
+  std::string& output,
+  std::string::size_type limit)
+{
+  if (exe != "task")
+    return _inner->runPty (exe, args, width, height, output, limit);
+
+  auto reply = answer (args);
+  std::cout << reply.output << std::flush;
+  output = reply.output;
+  return reply.status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ReplayExecutor::capture (
+  const std::string& exe,
+  const std::vector <std::string>& args,
+  std::string& output,
+  int timeout)
+{
+  if (exe != "task")
+    return _inner->capture (exe, args, output, timeout);
+
+  auto reply = answer (args);
+  output = reply.output;
+  return reply.status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ReplayExecutor::collect (
+  const std::string& exe,
+  const std::vector <std::string>& args,
+  std::string& output,
+  std::string& errors)
+{
+  if (exe != "task")
+    return _inner->collect (exe, args, output, errors);
+
+  auto reply = answer (args);
+  output = reply.output;
+  errors = reply.errors;
+  return reply.status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ReplayExecutor::stream (
+  const std::string& exe,
+  const std::vector <std::string>& args,
+  std::function <bool (const std::string&)> handler)
+{
+  if (exe != "task")
+    return _inner->stream (exe, args, handler);
+
+  auto reply = answer (args);
+  LineReader reader (handler);
+  reader.feed (reply.output.data (), reply.output.size ());
+  reader.finish ();
+  return reply.status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ReplayExecutor::Answer ReplayExecutor::answer (const std::vector <std::string>& args)
+{
+  std::lock_guard <std::mutex> lock (_mutex);
+  auto answers = _answers.find (replayKey (args));
+  if (answers == _answers.end ())
+    return {1, "", "Command not recorded.\n"};
+
+  auto reply = answers->second.front ();
+  if (answers->second.size () > 1)
+    answers->second.pop_front ();
+
+  return reply;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The default spawns programs.  The instance is created by whichever thread
+// first asks for it, which C++11 makes safe, but main selects it before
+// starting any other thread, so that it is never replaced while in use.
+static std::unique_ptr <Executor>& current ()
+{
+  static std::unique_ptr <Executor> instance (
+    new PoolExecutor (std::unique_ptr <Executor> (new SpawnExecutor ()),
+                      std::thread::hardware_concurrency ()));
+  return instance;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Executor& executor ()
+{
+  return *current ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Must be called before any other thread uses the executor.
+void selectExecutor (const std::string& spec)
+{
+  std::unique_ptr <Executor> spawner (new SpawnExecutor ());
+
+  if (spec == "spawn")
+    current ().reset (new PoolExecutor (std::move (spawner), std::thread::hardware_concurrency ()));
+
+  else if (spec.compare (0, 7, "record=") == 0 && spec.length () > 7)
+    current ().reset (new PoolExecutor (std::unique_ptr <Executor> (new RecordExecutor (std::move (spawner), spec.substr (7))),
+                                        std::thread::hardware_concurrency ()));
+
+  else if (spec.compare (0, 7, "replay=") == 0 && spec.length () > 7)
+    current ().reset (new ReplayExecutor (std::move (spawner), spec.substr (7)));
+
+  else
+    throw format ("Unrecognized executor '{1}'.", spec);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Must be called before any other thread uses the executor.
+void selectExecutor (std::unique_ptr <Executor> replacement)
+{
+  current () = std::move (replacement);
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,164 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_EXECUTOR
+#define INCLUDED_EXECUTOR
+
+#include <string>
+#include <functional>
+#include <vector>
+#include <map>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <fstream>
+#include <condition_variable>
+
+// Every program tasksh runs goes through an Executor, whose methods mirror
+// those in process.h:
+//   run      Inherits the terminal.
+//   runPty   Runs on a pseudo-terminal, copying output to stdout, and
+//            capturing it, up to an optional limit.
+//   capture  Captures stdout, with an optional timeout in milliseconds.
+//   collect  Captures stdout and stderr separately.
+//   stream   Hands each line of stdout to a callback as it arrives, until the
+//            callback returns false.
+class Executor
+{
+public:
+  virtual ~Executor () = default;
+
+  virtual int run     (const std::string&, const std::vector <std::string>&) = 0;
+  virtual int runPty  (const std::string&, const std::vector <std::string>&, unsigned short, unsigned short, std::string&, std::string::size_type limit = std::string::npos) = 0;
+  virtual int capture (const std::string&, const std::vector <std::string>&, std::string&, int timeout = 0) = 0;
+  virtual int collect (const std::string&, const std::vector <std::string>&, std::string&, std::string&) = 0;
+  virtual int stream  (const std::string&, const std::vector <std::string>&, std::function <bool (const std::string&)>) = 0;
+};
+
+// Runs programs directly, with posix_spawn.
+class SpawnExecutor : public Executor
+{
+public:
+  int run     (const std::string&, const std::vector <std::string>&) override;
+  int runPty  (const std::string&, const std::vector <std::string>&, unsigned short, unsigned short, std::string&, std::string::size_type limit = std::string::npos) override;
+  int capture (const std::string&, const std::vector <std::string>&, std::string&, int timeout = 0) override;
+  int collect (const std::string&, const std::vector <std::string>&, std::string&, std::string&) override;
+  int stream  (const std::string&, const std::vector <std::string>&, std::function <bool (const std::string&)>) override;
+};
+
+// Limits the number of programs that background threads capture at once, by
+// making further callers wait.  The main thread is never made to wait, so
+// the screen in front of the user never queues behind background work, and
+// interactive programs are not limited either.
+class PoolExecutor : public Executor
+{
+public:
+  PoolExecutor (std::unique_ptr <Executor>, unsigned int);
+
+  int run     (const std::string&, const std::vector <std::string>&) override;
+  int runPty  (const std::string&, const std::vector <std::string>&, unsigned short, unsigned short, std::string&, std::string::size_type limit = std::string::npos) override;
+  int capture (const std::string&, const std::vector <std::string>&, std::string&, int timeout = 0) override;
+  int collect (const std::string&, const std::vector <std::string>&, std::string&, std::string&) override;
+  int stream  (const std::string&, const std::vector <std::string>&, std::function <bool (const std::string&)>) override;
+
+private:
+  bool acquire ();
+  void release ();
+
+private:
+  std::unique_ptr <Executor> _inner;
+  unsigned int               _limit;
+  unsigned int               _running {0};
+  std::mutex                 _mutex   {};
+  std::condition_variable    _free    {};
+};
+
+// Runs Taskwarrior, and appends each command and its results to a file, one
+// JSON object per line, for ReplayExecutor.
+class RecordExecutor : public Executor
+{
+public:
+  RecordExecutor (std::unique_ptr <Executor>, const std::string&);
+
+  int run     (const std::string&, const std::vector <std::string>&) override;
+  int runPty  (const std::string&, const std::vector <std::string>&, unsigned short, unsigned short, std::string&, std::string::size_type limit = std::string::npos) override;
+  int capture (const std::string&, const std::vector <std::string>&, std::string&, int timeout = 0) override;
+  int collect (const std::string&, const std::vector <std::string>&, std::string&, std::string&) override;
+  int stream  (const std::string&, const std::vector <std::string>&, std::function <bool (const std::string&)>) override;
+
+private:
+  void record (const std::string&, const std::vector <std::string>&, int, const std::string&, const std::string&);
+
+private:
+  std::unique_ptr <Executor> _inner;
+  std::ofstream              _file;
+  std::mutex                 _mutex {};
+};
+
+// Answers Taskwarrior commands from a file written by RecordExecutor, without
+// running anything.  Repeated commands are answered in the order recorded,
+// and the last answer is repeated thereafter.  Unrecorded commands fail.
+class ReplayExecutor : public Executor
+{
+public:
+  ReplayExecutor (std::unique_ptr <Executor>, const std::string&);
+
+  int run     (const std::string&, const std::vector <std::string>&) override;
+  int runPty  (const std::string&, const std::vector <std::string>&, unsigned short, unsigned short, std::string&, std::string::size_type limit = std::string::npos) override;
+  int capture (const std::string&, const std::vector <std::string>&, std::string&, int timeout = 0) override;
+  int collect (const std::string&, const std::vector <std::string>&, std::string&, std::string&) override;
+  int stream  (const std::string&, const std::vector <std::string>&, std::function <bool (const std::string&)>) override;
+
+private:
+  struct Answer
+  {
+    int         status;
+    std::string output;
+    std::string errors;
+  };
+
+  Answer answer (const std::vector <std::string>&);
+
+private:
+  std::unique_ptr <Executor>                    _inner;
+  std::map <std::string, std::deque <Answer>>   _answers {};
+  std::mutex                                    _mutex   {};
+};
+
+// The executor in use, which by default spawns programs, at most one per CPU
+// concurrently for captures.  The alternatives are selected by:
+//   record=<file>   Record Taskwarrior commands.
+//   replay=<file>   Replay recorded commands.
+Executor& executor ();
+void selectExecutor (const std::string&);
+
+// Installs an executor of the caller's own, such as one in a test.
+void selectExecutor (std::unique_ptr <Executor>);
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
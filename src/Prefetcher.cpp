@@ -0,0 +1,204 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <Prefetcher.h>
+#include <algorithm>
+#include <Executor.h>
+#include <process.h>
+#include <Trace.h>
+#include <format.h>
+
+////////////////////////////////////////////////////////////////////////////////
+Prefetcher::Prefetcher (unsigned int workers, unsigned int width, bool color)
+: _width (width)
+, _color (color)
+{
+  for (unsigned int i = 0; i < workers; ++i)
+    _workers.push_back (std::thread (&Prefetcher::worker, this));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Prefetcher::~Prefetcher ()
+{
+  {
+    std::lock_guard <std::mutex> lock (_mutex);
+    _stop = true;
+    _todo.clear ();
+  }
+
+  _changed.notify_all ();
+  for (auto& worker : _workers)
+    worker.join ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Queue a task for rendering, unless it is already rendered or queued.
+void Prefetcher::request (const Uuid& uuid)
+{
+  {
+    std::lock_guard <std::mutex> lock (_mutex);
+    if (_workers.size () == 0 ||
+        _entries.find (uuid) != _entries.end ())
+      return;
+
+    _entries[uuid] = {++_tickets, false, ""};
+    _todo.push_back (uuid);
+  }
+
+  _changed.notify_all ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Return the rendered output, waiting for a worker if it is in progress, or
+// rendering it here if it was never requested.
+std::string Prefetcher::get (const Uuid& uuid)
+{
+  std::unique_lock <std::mutex> lock (_mutex);
+  auto entry = _entries.find (uuid);
+  if (entry != _entries.end ())
+  {
+    // Not yet started, so there is no point waiting for a worker.
+    auto queued = std::find (_todo.begin (), _todo.end (), uuid);
+    if (queued != _todo.end ())
+    {
+      _todo.erase (queued);
+      _entries.erase (entry);
+    }
+    else
+    {
+      trace.instant (entry->second.ready ? "prefetch.hit" : "prefetch.wait", "cache", uuid.str ());
+
+      auto ticket = entry->second.ticket;
+      _changed.wait (lock, [this, &uuid, ticket] {
+        auto e = _entries.find (uuid);
+        return e == _entries.end () || e->second.ticket != ticket || e->second.ready;
+      });
+
+      entry = _entries.find (uuid);
+      if (entry != _entries.end () && entry->second.ready)
+        return entry->second.output;
+    }
+  }
+
+  lock.unlock ();
+  trace.instant ("prefetch.miss", "cache", uuid.str ());
+  auto output = render (uuid);
+
+  lock.lock ();
+  _entries[uuid] = {++_tickets, true, output};
+  return output;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Forget any rendered or in-progress output, for example because the task was
+// just modified.  A render already underway is discarded when it completes.
+void Prefetcher::invalidate (const Uuid& uuid)
+{
+  {
+    std::lock_guard <std::mutex> lock (_mutex);
+    auto queued = std::find (_todo.begin (), _todo.end (), uuid);
+    if (queued != _todo.end ())
+      _todo.erase (queued);
+
+    _entries.erase (uuid);
+  }
+
+  _changed.notify_all ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Forget everything, because the data changed.  Renders underway are
+// discarded when they complete.
+void Prefetcher::clear ()
+{
+  {
+    std::lock_guard <std::mutex> lock (_mutex);
+    _todo.clear ();
+    _entries.clear ();
+  }
+
+  _changed.notify_all ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Prefetcher::worker ()
+{
+  blockInterrupts ();
+
+  std::unique_lock <std::mutex> lock (_mutex);
+  while (true)
+  {
+    _changed.wait (lock, [this] { return _stop || _todo.size (); });
+    if (_stop)
+      return;
+
+    auto uuid = _todo.front ();
+    _todo.pop_front ();
+    auto ticket = _entries[uuid].ticket;
+
+    lock.unlock ();
+    auto output = render (uuid);
+    lock.lock ();
+
+    // Only keep the result if it was not invalidated meanwhile.
+    auto entry = _entries.find (uuid);
+    if (entry != _entries.end () && entry->second.ticket == ticket)
+    {
+      entry->second.ready = true;
+      entry->second.output = output;
+    }
+
+    _changed.notify_all ();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Like the other background reads, renders neither collect garbage nor
+// generate recurring tasks, and run no hooks, so that they never write to the
+// data files while the review writes to them in the foreground.
+std::string Prefetcher::render (const Uuid& uuid) const
+{
+  std::vector <std::string> args {"rc.gc=off", "rc.recurrence=off", "rc.hooks=off"};
+  if (_width)
+  {
+    args.push_back ("rc.detection=off");
+    args.push_back (format ("rc.defaultwidth={1}", _width));
+  }
+
+  if (_color)
+    args.push_back ("rc._forcecolor=on");
+
+  args.push_back (uuid.str ());
+  args.push_back ("information");
+
+  std::string output;
+  executor ().capture ("task", args, output);
+  return output;
+}
+
+////////////////////////////////////////////////////////////////////////////////
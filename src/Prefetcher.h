@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_PREFETCHER
+#define INCLUDED_PREFETCHER
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <Uuid.h>
+
+// Renders 'task <uuid> information' for upcoming tasks on a small pool of
+// background threads, so that the output is ready by the time it is needed.
+class Prefetcher
+{
+public:
+  Prefetcher (unsigned int, unsigned int, bool);
+  ~Prefetcher ();
+
+  void request (const Uuid&);
+  std::string get (const Uuid&);
+  void invalidate (const Uuid&);
+  void clear ();
+
+private:
+  void worker ();
+  std::string render (const Uuid&) const;
+
+private:
+  struct Entry
+  {
+    unsigned long ticket;
+    bool          ready;
+    std::string   output;
+  };
+
+  std::mutex                       _mutex    {};
+  std::condition_variable          _changed  {};
+  std::deque <Uuid>                _todo     {};
+  std::unordered_map <Uuid, Entry> _entries  {};
+  std::vector <std::thread>        _workers  {};
+  unsigned long                    _tickets  {0};
+  bool                             _stop     {false};
+  unsigned int                     _width    {80};
+  bool                             _color    {false};
+};
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
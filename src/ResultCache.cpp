@@ -0,0 +1,106 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <ResultCache.h>
+#include <Watcher.h>
+#include <format.h>
+
+const std::string::size_type ResultCache::maxOutput;
+
+////////////////////////////////////////////////////////////////////////////////
+std::string ResultCache::key (
+  const std::vector <std::string>& args,
+  unsigned int width)
+{
+  std::string key = format ("{1}:{2}:{3}",
+                            width,
+                            watcher.dataGeneration (),
+                            watcher.configGeneration ());
+  for (auto& arg : args)
+    key += '\x1f' + arg;
+
+  return key;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ResultCache::lookup (const std::string& key, std::string& output)
+{
+  auto now = time (NULL);
+  for (auto i = _entries.begin (); i != _entries.end (); ++i)
+  {
+    if (i->key == key)
+    {
+      if (now - i->stored > _ttl)
+      {
+        _entries.erase (i);
+        return false;
+      }
+
+      output = i->output;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ResultCache::store (const std::string& key, const std::string& output)
+{
+  if (output.size () > maxOutput)
+    return;
+
+  for (auto i = _entries.begin (); i != _entries.end (); ++i)
+  {
+    if (i->key == key)
+    {
+      _entries.erase (i);
+      break;
+    }
+  }
+
+  // The oldest entry makes room.
+  if (_entries.size () >= _capacity)
+    _entries.erase (_entries.begin ());
+
+  _entries.push_back ({key, output, time (NULL)});
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ResultCache::clear ()
+{
+  _entries.clear ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ResultCache::ttl (time_t seconds)
+{
+  _ttl = seconds;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_RESULTCACHE
+#define INCLUDED_RESULTCACHE
+
+#include <string>
+#include <vector>
+#include <ctime>
+
+// Remembers the output of read-only commands.  Entries are keyed on the
+// command line, the terminal width, and the Watcher generations of the data
+// files and .taskrc, so any change to those is a miss.  Entries also expire,
+// because reports show relative dates.
+class ResultCache
+{
+public:
+  ResultCache () = default;
+
+  static std::string key (const std::vector <std::string>&, unsigned int);
+
+  // Larger outputs, typically exports, are not worth keeping.
+  static const std::string::size_type maxOutput = 1 << 20;
+
+  bool lookup (const std::string&, std::string&);
+  void store (const std::string&, const std::string&);
+  void clear ();
+  void ttl (time_t);
+
+private:
+  struct Entry
+  {
+    std::string key;
+    std::string output;
+    time_t      stored;
+  };
+
+  std::vector <Entry> _entries  {};
+  time_t              _ttl      {60};
+  unsigned int        _capacity {16};
+};
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
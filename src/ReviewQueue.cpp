@@ -0,0 +1,409 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <ReviewQueue.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <Executor.h>
+#include <process.h>
+#include <Trace.h>
+#include <format.h>
+
+static_assert (sizeof (Uuid) == 16, "Checkpoints store Uuids as their bytes.");
+
+////////////////////////////////////////////////////////////////////////////////
+// A limit of 0 means no limit.  The loader exports the metadata of a page of
+// tasks.
+ReviewQueue::ReviewQueue (
+  unsigned int limit,
+  unsigned int pageSize,
+  std::function <void (const std::vector <Uuid>&, std::unordered_map <Uuid, Task>&)> load)
+: _limit (limit)
+, _pageSize (std::max (pageSize, 1u))
+, _load (load)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A page still being fetched must finish, as it refers to this queue.
+ReviewQueue::~ReviewQueue ()
+{
+  if (_next.valid ())
+    _next.wait ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Counts the tasks matching the '_reviewed' report filter, while the first
+// page is fetched.
+void ReviewQueue::start (const std::string& filter)
+{
+  Span span ("review.fetch", "review");
+
+  std::future <unsigned int> count;
+  if (filter != "")
+  {
+    std::vector <std::string> args {"rc.verbose=nothing", "rc.gc=off", "rc.recurrence=off", "rc.hooks=off"};
+    for (auto& word : tokenize (filter))
+      args.push_back (word);
+
+    args.push_back ("count");
+
+    count = std::async (std::launch::async, [args] () -> unsigned int
+    {
+      blockInterrupts ();
+
+      std::string output;
+      if (executor ().capture ("task", args, output) != 0)
+        return 0;
+
+      return strtoul (output.c_str (), NULL, 10);
+    });
+  }
+
+  auto first = fetch ();
+
+  // Without a count, the first page is all that is known.
+  _total = count.valid () ? count.get () : first.uuids.size ();
+  if (_limit && (_total == 0 || _total > _limit))
+    _total = _limit;
+
+  merge (std::move (first));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Resumes from a checkpoint saved with the same report filter, no more than
+// 'ttl' seconds ago.  Returns false, having done nothing, if there is none.
+//
+// The checkpoint is a short text header, then the packed UUIDs:
+//   tasksh-review 1
+//   <saved, epoch> <remaining tasks> <UUIDs>
+//   <data files signature>
+//   <report filter>
+bool ReviewQueue::resume (
+  const std::string& file,
+  const std::string& filter,
+  const std::string& signature,
+  time_t ttl)
+{
+  std::ifstream in (file, std::ios::binary);
+  std::string magic;
+  std::string counts;
+  std::string savedSignature;
+  std::string savedFilter;
+  if (! std::getline (in, magic)          ||
+      ! std::getline (in, counts)         ||
+      ! std::getline (in, savedSignature) ||
+      ! std::getline (in, savedFilter)    ||
+      magic != "tasksh-review 1"          ||
+      savedFilter != filter)
+    return false;
+
+  long long saved;
+  unsigned int remaining;
+  size_t count;
+  std::stringstream numbers (counts);
+  if (! (numbers >> saved >> remaining >> count) ||
+      count == 0 ||
+      time (NULL) - saved > ttl)
+    return false;
+
+  std::vector <Uuid> uuids (count);
+  if (! in.read ((char*) uuids.data (), count * sizeof (Uuid)))
+    return false;
+
+  Span span ("review.resume", "review");
+
+  // Nothing to re-evaluate if the data files are as they were.
+  _total = remaining;
+  if (savedSignature != signature)
+    reconcile ((time_t) saved, uuids);
+
+  _saved = std::move (uuids);
+  merge (fetch ());
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Saves the tasks from the cursor on, whether fetched or not, or removes the
+// checkpoint if there are none.  The signature must be taken after the
+// session's own writes, so that they do not count as changes.
+void ReviewQueue::save (
+  const std::string& file,
+  const std::string& filter,
+  const std::string& signature,
+  unsigned int cursor) const
+{
+  std::vector <Uuid> rest (_uuids.begin () + std::min ((size_t) cursor, _uuids.size ()), _uuids.end ());
+  rest.insert (rest.end (), _saved.begin () + _savedNext, _saved.end ());
+  if (rest.size () == 0)
+  {
+    std::remove (file.c_str ());
+    return;
+  }
+
+  auto remaining = std::max ((unsigned int) rest.size (), _total > cursor ? _total - cursor : 0);
+
+  // Written aside, then renamed, so a checkpoint is never partial.
+  auto temporary = file + ".new";
+  {
+    std::ofstream out (temporary, std::ios::binary | std::ios::trunc);
+    out << "tasksh-review 1\n"
+        << (long long) time (NULL) << ' ' << remaining << ' ' << rest.size () << '\n'
+        << signature << '\n'
+        << filter << '\n';
+    out.write ((const char*) rest.data (), rest.size () * sizeof (Uuid));
+    if (! out.good ())
+    {
+      out.close ();
+      std::remove (temporary.c_str ());
+      return;
+    }
+  }
+
+  std::rename (temporary.c_str (), file.c_str ());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned int ReviewQueue::total () const
+{
+  return _total;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Returns the UUID at the given position, fetching pages as needed, or false
+// if the report has no more tasks.  Reaching the middle of the last page
+// starts fetching the next, in the background.
+bool ReviewQueue::get (unsigned int index, Uuid& uuid)
+{
+  if (_limit && index >= _limit)
+    return false;
+
+  while (index >= _uuids.size () && ! _exhausted)
+  {
+    if (! _next.valid ())
+    {
+      Span span ("review.page", "review");
+      merge (fetch ());
+    }
+    else
+    {
+      trace.instant ("review.page.wait", "review");
+      merge (_next.get ());
+    }
+  }
+
+  if (! _exhausted &&
+      ! _next.valid () &&
+      index + _pageSize / 2 >= _uuids.size ())
+    _next = std::async (std::launch::async, [this]
+    {
+      blockInterrupts ();
+      return fetch ();
+    });
+
+  if (index >= _uuids.size ())
+  {
+    // The report ended early, perhaps because tasks were changed elsewhere.
+    _total = _uuids.size ();
+    return false;
+  }
+
+  uuid = _uuids[index];
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const std::vector <Uuid>& ReviewQueue::uuids () const
+{
+  return _uuids;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::unordered_map <Uuid, Task>& ReviewQueue::tasks ()
+{
+  return _tasks;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Runs in the background, so only reads the queue, which does not change
+// until the page is merged.  Any resumed tasks come first.
+ReviewQueue::Page ReviewQueue::fetch () const
+{
+  Page page {{}, {}, false, 0};
+  if (_savedNext < _saved.size ())
+  {
+    while (_savedNext + page.consumed < _saved.size () &&
+           page.uuids.size () < _pageSize)
+    {
+      auto& uuid = _saved[_savedNext + page.consumed++];
+      if (_known.find (uuid) == _known.end ())
+        page.uuids.push_back (uuid);
+    }
+
+    _load (page.uuids, page.tasks);
+    return page;
+  }
+
+  // The limit at least doubles each time, so the report is run a logarithmic
+  // number of times, and its output, which repeats every task already known,
+  // totals at most about twice the tasks reviewed.
+  auto wanted = std::max (_known.size () + _pageSize, _known.size () * 2);
+  if (_limit)
+    wanted = std::min (wanted, (size_t) _limit);
+
+  unsigned int lines = 0;
+  Uuid uuid;
+  executor ().stream ("task",
+                      {
+                        "rc.color=off",
+                        "rc.detection=off",
+                        "rc._forcecolor=off",
+                        "rc.verbose=nothing",
+                        "_reviewed",
+                        format ("limit:{1}", wanted)
+                      },
+                      [this, &page, &lines, &uuid] (const std::string& line)
+                      {
+                        if (Uuid::parse (line, uuid))
+                        {
+                          ++lines;
+                          if (_known.find (uuid) == _known.end ())
+                            page.uuids.push_back (uuid);
+                        }
+
+                        return true;
+                      });
+
+  page.last = lines < wanted || page.uuids.size () == 0;
+  _load (page.uuids, page.tasks);
+  return page;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ReviewQueue::merge (Page page)
+{
+  _savedNext += page.consumed;
+
+  for (auto& uuid : page.uuids)
+  {
+    if (_limit && _uuids.size () >= _limit)
+      break;
+
+    if (_known.insert (uuid).second)
+      _uuids.push_back (uuid);
+  }
+
+  for (auto& task : page.tasks)
+    _tasks[task.first] = std::move (task.second);
+
+  if (page.last ||
+      (_limit && _uuids.size () >= _limit))
+    _exhausted = true;
+
+  // The count may be out of date, so what the report returned prevails.
+  if (_exhausted || _uuids.size () > _total)
+    _total = _uuids.size ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Re-evaluates only the tasks modified since the checkpoint.  Those that no
+// longer match the report are dropped, and those that newly match are added
+// at the end, which is where the report sorts recently modified tasks.
+void ReviewQueue::reconcile (time_t saved, std::vector <Uuid>& uuids)
+{
+  // A second earlier, because Taskwarrior records whole seconds.
+  char since[32];
+  time_t from = saved - 1;
+  strftime (since, sizeof (since), "modified.after:%Y%m%dT%H%M%SZ", gmtime (&from));
+
+  std::unordered_set <Uuid> changed;
+  Task task;
+  Uuid parsed;
+  executor ().stream ("task",
+                      {"rc.verbose=nothing", "rc.gc=off", "rc.json.array=off", since, "export"},
+                      [this, &changed, &task, &parsed] (const std::string& line)
+                      {
+                        if (parseExportLine (line, task) &&
+                            Uuid::parse (task.get ("uuid"), parsed))
+                        {
+                          changed.insert (parsed);
+                          _tasks[parsed] = task;
+                        }
+
+                        return true;
+                      });
+
+  std::vector <Uuid> matching;
+  executor ().stream ("task",
+                      {
+                        "rc.color=off",
+                        "rc.detection=off",
+                        "rc._forcecolor=off",
+                        "rc.verbose=nothing",
+                        since,
+                        "_reviewed"
+                      },
+                      [&matching, &parsed] (const std::string& line)
+                      {
+                        if (Uuid::parse (line, parsed))
+                          matching.push_back (parsed);
+
+                        return true;
+                      });
+
+  std::unordered_set <Uuid> matches (matching.begin (), matching.end ());
+  std::unordered_set <Uuid> kept;
+  std::vector <Uuid> reconciled;
+  for (auto& uuid : uuids)
+    if (changed.find (uuid) == changed.end () ||
+        matches.find (uuid) != matches.end ())
+    {
+      reconciled.push_back (uuid);
+      kept.insert (uuid);
+    }
+
+  auto removed = uuids.size () - reconciled.size ();
+  for (auto& uuid : matching)
+    if (kept.find (uuid) == kept.end ())
+      reconciled.push_back (uuid);
+
+  // Tasks beyond those saved were only counted, and may be among those added,
+  // so the total is only adjusted for additions if every task was saved.
+  auto added = reconciled.size () + removed - uuids.size ();
+  if (uuids.size () < _total)
+    added = 0;
+
+  _total = _total + added > removed ? _total + added - removed : 0;
+  _total = std::max (_total, (unsigned int) reconciled.size ());
+  uuids = std::move (reconciled);
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,99 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_REVIEWQUEUE
+#define INCLUDED_REVIEWQUEUE
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include <future>
+#include <ctime>
+#include <Uuid.h>
+#include <Task.h>
+
+// The tasks to review, fetched from the '_reviewed' report a page at a time,
+// so that 'review N' only asks Taskwarrior for N tasks.  The next page is
+// fetched in the background as the review nears the end of the current one.
+// The total is counted separately, with the report filter.
+//
+// Each page is requested with a 'limit:' covering every task already known,
+// and those are skipped, because reviewing a task removes it from the report,
+// so an offset would not be stable.  After the first page, each page is as
+// large as everything fetched before it.
+//
+// A session that stops early saves the rest of the queue to a checkpoint
+// file.  The next session resumes from it, instead of the report, after
+// re-evaluating only the tasks modified meanwhile.  Tasks that became due for
+// review without being modified are found in the report once the saved queue
+// is used up.
+class ReviewQueue
+{
+public:
+  ReviewQueue (unsigned int, unsigned int, std::function <void (const std::vector <Uuid>&, std::unordered_map <Uuid, Task>&)>);
+  ~ReviewQueue ();
+
+  void start (const std::string&);
+  bool resume (const std::string&, const std::string&, const std::string&, time_t);
+  void save (const std::string&, const std::string&, const std::string&, unsigned int) const;
+  unsigned int total () const;
+  bool get (unsigned int, Uuid&);
+  const std::vector <Uuid>& uuids () const;
+  std::unordered_map <Uuid, Task>& tasks ();
+
+private:
+  struct Page
+  {
+    std::vector <Uuid>              uuids;
+    std::unordered_map <Uuid, Task> tasks;
+    bool                            last;
+    unsigned int                    consumed;
+  };
+
+  Page fetch () const;
+  void merge (Page);
+  void reconcile (time_t, std::vector <Uuid>&);
+
+private:
+  unsigned int                     _limit;
+  unsigned int                     _pageSize;
+  std::function <void (const std::vector <Uuid>&, std::unordered_map <Uuid, Task>&)> _load;
+  unsigned int                     _total     {0};
+  bool                             _exhausted {false};
+  std::vector <Uuid>               _uuids     {};
+  std::unordered_set <Uuid>        _known     {};
+  std::vector <Uuid>               _saved     {};
+  unsigned int                     _savedNext {0};
+  std::unordered_map <Uuid, Task>  _tasks     {};
+  std::future <Page>               _next      {};
+};
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
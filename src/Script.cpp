@@ -0,0 +1,209 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <Script.h>
+#include <vector>
+#include <algorithm>
+#include <Lexer.h>
+#include <process.h>
+#include <dispatch.h>
+
+Script script;
+
+// Commands that apply the same change to every task in the filter.  Taskwarrior
+// does not renumber IDs for these, so 'N cmd' followed by 'M cmd' is the same
+// as 'N M cmd'.
+static std::vector <std::string> mergeable = {
+  "annotate",
+  "append",
+  "delete",
+  "denotate",
+  "done",
+  "modify",
+  "prepend",
+  "start",
+  "stop",
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// IDs, ID ranges and lists ("12", "3-5", "1,4"), and full or short UUIDs.
+static bool isIdentifier (const std::string& word)
+{
+  if (word.find_first_not_of ("0123456789,-") == std::string::npos)
+    return Lexer::isDigit (word[0]) && Lexer::isDigit (word.back ());
+
+  if (word.length () == 8 || word.length () == 36)
+  {
+    for (unsigned int i = 0; i < word.length (); ++i)
+      if (i == 8 || i == 13 || i == 18 || i == 23)
+      {
+        if (word[i] != '-')
+          return false;
+      }
+      else if (! Lexer::isHexDigit (word[i]))
+        return false;
+
+    return true;
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Split a line into its leading identifiers and the remainder, which is kept
+// as written.  Returns false if the line is not a mergeable mutation.
+static bool splitMutation (
+  const std::string& line,
+  std::string& ids,
+  std::string& rest)
+{
+  std::string::size_type cursor = 0;
+  ids = "";
+
+  while (true)
+  {
+    auto start = line.find_first_not_of (" \t", cursor);
+    if (start == std::string::npos)
+      return false;
+
+    auto end = line.find_first_of (" \t", start);
+    auto word = line.substr (start, end == std::string::npos ? std::string::npos : end - start);
+    if (! isIdentifier (word))
+    {
+      rest = line.substr (start);
+      break;
+    }
+
+    ids += (ids != "" ? " " : "") + word;
+    cursor = end == std::string::npos ? line.length () : end;
+  }
+
+  if (ids == "")
+    return false;
+
+  // Lines that need the shell, for a pipe or redirection, are run as written.
+  if (needsShell (rest))
+    return false;
+
+  // The command must follow the identifiers directly, so that the filter is
+  // only the identifiers.
+  auto words = tokenize (rest);
+  if (words.size () == 0)
+    return false;
+
+  auto name = commandName ({words[0]});
+  return std::find (mergeable.begin (), mergeable.end (), name) != mergeable.end ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Blank lines and comments are skipped.
+void Script::load (std::istream& in)
+{
+  _active = true;
+
+  std::string line;
+  while (std::getline (in, line))
+  {
+    auto trimmed = Lexer::trim (line, " \t\r");
+    if (trimmed != "" && trimmed[0] != '#')
+      _lines.push_back (trimmed);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool Script::active () const
+{
+  return _active;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The next line, as typed.  Used for responses to prompts.
+bool Script::next (std::string& line)
+{
+  if (_lines.empty ())
+    return false;
+
+  line = _lines.front ();
+  _lines.pop_front ();
+  ++_taken;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The next command, merged with any consecutive lines that make the same
+// change to other tasks:
+//
+//   12 modify +work      ->  rc.bulk=0 12 13 modify +work
+//   13 modify +work
+//
+// rc.bulk=0 keeps Taskwarrior from asking for a confirmation that the
+// separate commands would not have needed.
+bool Script::take (std::string& command)
+{
+  if (! next (command))
+    return false;
+
+  ++_runs;
+
+  std::string ids;
+  std::string rest;
+  if (! splitMutation (command, ids, rest))
+    return true;
+
+  unsigned int merged = 0;
+  std::string moreIds;
+  std::string moreRest;
+  while (_lines.size () &&
+         splitMutation (_lines.front (), moreIds, moreRest) &&
+         moreRest == rest)
+  {
+    ids += ' ' + moreIds;
+    _lines.pop_front ();
+    ++_taken;
+    ++merged;
+  }
+
+  if (merged)
+    command = "rc.bulk=0 " + ids + ' ' + rest;
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned int Script::lines () const
+{
+  return _taken;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned int Script::runs () const
+{
+  return _runs;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_SCRIPT
+#define INCLUDED_SCRIPT
+
+#include <string>
+#include <deque>
+#include <istream>
+
+// The commands of a batch session, read up front from a script file or from
+// non-interactive standard input.
+class Script
+{
+public:
+  void load (std::istream&);
+  bool active () const;
+
+  bool next (std::string&);
+  bool take (std::string&);
+
+  unsigned int lines () const;
+  unsigned int runs () const;
+
+private:
+  std::deque <std::string> _lines  {};
+  bool                     _active {false};
+  unsigned int             _taken  {0};
+  unsigned int             _runs   {0};
+};
+
+extern Script script;
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
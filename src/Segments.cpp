@@ -0,0 +1,222 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <Segments.h>
+#include <fstream>
+#include <Datetime.h>
+#include <Lexer.h>
+#include <format.h>
+#include <Executor.h>
+#include <process.h>
+
+Segments segments;
+
+////////////////////////////////////////////////////////////////////////////////
+Segments::~Segments ()
+{
+  stop ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Segments are shown in the order given.  Unknown names are ignored.  The
+// budget is the number of milliseconds allowed for computing each segment.
+void Segments::start (const std::vector <std::string>& names, int budget)
+{
+  for (auto& name : names)
+    if (name == "pending" ||
+        name == "overdue" ||
+        name == "context" ||
+        name == "sync"    ||
+        name == "time")
+      _names.push_back (name);
+
+  _budget = budget > 0 ? budget : 250;
+
+  for (auto& name : _names)
+    if (name != "time")
+    {
+      _thread = std::thread (&Segments::worker, this);
+      break;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Segments::stop ()
+{
+  {
+    std::lock_guard <std::mutex> lock (_mutex);
+    _stop = true;
+  }
+
+  _changed.notify_all ();
+  if (_thread.joinable ())
+    _thread.join ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool Segments::running () const
+{
+  return _thread.joinable ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Called before each prompt with the current generations from the watcher.
+// Only a change wakes the worker, so an idle prompt costs nothing.
+void Segments::update (
+  unsigned long data,
+  unsigned long config,
+  const std::string& location)
+{
+  {
+    std::lock_guard <std::mutex> lock (_mutex);
+    if (data == _wanted[0] && config == _wanted[1])
+      return;
+
+    _wanted[0] = data;
+    _wanted[1] = config;
+    _location = location;
+  }
+
+  _changed.notify_all ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string Segments::compose () const
+{
+  std::lock_guard <std::mutex> lock (_mutex);
+
+  std::string combined;
+  for (auto& name : _names)
+  {
+    std::string value;
+    if (name == "time")
+    {
+      value = Datetime ().toString ("H:N");
+    }
+    else
+    {
+      auto found = _values.find (name);
+      if (found != _values.end ())
+        value = found->second;
+    }
+
+    if (value != "")
+      combined += (combined != "" ? " " : "") + value;
+  }
+
+  return combined;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Segments::worker ()
+{
+  blockInterrupts ();
+
+  std::unique_lock <std::mutex> lock (_mutex);
+  while (true)
+  {
+    _changed.wait (lock, [this] { return _stop                  ||
+                                         _wanted[0] != _done[0] ||
+                                         _wanted[1] != _done[1]; });
+    if (_stop)
+      return;
+
+    _done[0] = _wanted[0];
+    _done[1] = _wanted[1];
+    auto location = _location;
+
+    for (auto& name : _names)
+    {
+      if (name == "time")
+        continue;
+
+      lock.unlock ();
+      std::string value;
+      bool ok = compute (name, location, value);
+      lock.lock ();
+
+      if (_stop)
+        return;
+
+      // A segment that exceeded its budget keeps its last known value.
+      if (ok)
+        _values[name] = value;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Taskwarrior runs without garbage collection, recurrence or hooks, so that
+// computing a segment never modifies the data files, which would trigger
+// another update.
+bool Segments::compute (
+  const std::string& name,
+  const std::string& location,
+  std::string& value) const
+{
+  value = "";
+
+  if (name == "sync")
+  {
+    // Local changes not yet synced are the JSON lines in backlog.data.
+    std::ifstream backlog (location + "/backlog.data");
+    int count = 0;
+    std::string line;
+    while (std::getline (backlog, line))
+      if (line.length () && line[0] == '{')
+        ++count;
+
+    if (count)
+      value = format ("unsynced:{1}", count);
+
+    return true;
+  }
+
+  std::vector <std::string> args {"rc.verbose=nothing", "rc.gc=off", "rc.recurrence=off", "rc.hooks=off"};
+  if (name == "pending")
+    args.insert (args.end (), {"+PENDING", "count"});
+  else if (name == "overdue")
+    args.insert (args.end (), {"+OVERDUE", "count"});
+  else if (name == "context")
+    args.insert (args.end (), {"_get", "rc.context"});
+
+  std::string output;
+  if (executor ().capture ("task", args, output, _budget) != 0)
+    return false;
+
+  output = Lexer::trim (output, " \t\n");
+  if (name == "overdue" && output == "0")
+    return true;
+
+  if (output != "")
+    value = name + ':' + output;
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
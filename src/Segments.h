@@ -0,0 +1,75 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_SEGMENTS
+#define INCLUDED_SEGMENTS
+
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// The status segments shown in the prompt, such as the number of pending
+// tasks.  Segments that need Taskwarrior are computed on a background thread,
+// each within a time budget, and only when the data files or configuration
+// have changed.  The prompt shows the last values computed, and never waits.
+class Segments
+{
+public:
+  Segments () = default;
+  ~Segments ();
+
+  void start (const std::vector <std::string>&, int);
+  void stop ();
+  bool running () const;
+  void update (unsigned long, unsigned long, const std::string&);
+  std::string compose () const;
+
+private:
+  void worker ();
+  bool compute (const std::string&, const std::string&, std::string&) const;
+
+private:
+  mutable std::mutex                  _mutex      {};
+  std::condition_variable             _changed    {};
+  std::thread                         _thread     {};
+  std::vector <std::string>           _names      {};
+  std::map <std::string, std::string> _values     {};
+  unsigned long                       _wanted[2]  {0, 0};
+  unsigned long                       _done[2]    {0, 0};
+  std::string                         _location   {};
+  int                                 _budget     {250};
+  bool                                _stop       {false};
+};
+
+extern Segments segments;
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
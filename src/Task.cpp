@@ -0,0 +1,147 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <Task.h>
+#include <iostream>
+#include <memory>
+#include <JSON.h>
+#include <Datetime.h>
+#include <Lexer.h>
+#include <shared.h>
+#include <format.h>
+
+////////////////////////////////////////////////////////////////////////////////
+bool Task::has (const std::string& name) const
+{
+  return _data.find (name) != _data.end ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string Task::get (const std::string& name) const
+{
+  auto i = _data.find (name);
+  if (i != _data.end ())
+    return i->second;
+
+  return "";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Task::set (const std::string& name, const std::string& value)
+{
+  _data[name] = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const std::map <std::string, std::string>& Task::all () const
+{
+  return _data;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static std::string scalar (json::value* value)
+{
+  if (value->type () == json::j_string)
+    return json::decode (((json::string*) value)->_data);
+
+  return value->dump ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static Task parseTask (json::object* object)
+{
+  Task task;
+  for (auto& attribute : object->_data)
+  {
+    if (attribute.first == "tags" &&
+        attribute.second->type () == json::j_array)
+    {
+      std::vector <std::string> tags;
+      for (auto& tag : ((json::array*) attribute.second)->_data)
+        tags.push_back (scalar (tag));
+
+      task.set ("tags", join (",", tags));
+    }
+    else if (attribute.first == "annotations" &&
+             attribute.second->type () == json::j_array)
+    {
+      for (auto& annotation : ((json::array*) attribute.second)->_data)
+      {
+        if (annotation->type () != json::j_object)
+          continue;
+
+        auto fields = ((json::object*) annotation)->_data;
+        if (fields.find ("entry") != fields.end () &&
+            fields.find ("description") != fields.end ())
+        {
+          Datetime entry (scalar (fields["entry"]));
+          task.set (format ("annotation_{1}", entry.toEpoch ()), scalar (fields["description"]));
+        }
+      }
+    }
+    else
+    {
+      task.set (attribute.first, scalar (attribute.second));
+    }
+  }
+
+  return task;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Taskwarrior writes one task per line in both formats, so each line can be
+// parsed alone, once any separating comma is removed.
+bool parseExportLine (const std::string& line, Task& task)
+{
+  auto text = Lexer::trim (line, " \t\r");
+  if (text != "" && text.back () == ',')
+    text.pop_back ();
+
+  if (text == "" || text[0] != '{')
+    return false;
+
+  std::unique_ptr <json::value> root;
+  try
+  {
+    root.reset (json::parse (text));
+  }
+
+  catch (const std::string& error)
+  {
+    std::cerr << format ("Skipped a task that could not be parsed ({1}): {2}", error, text) << "\n";
+    return false;
+  }
+
+  if (! root || root->type () != json::j_object)
+    return false;
+
+  task = parseTask ((json::object*) root.get ());
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_TASK
+#define INCLUDED_TASK
+
+#include <map>
+#include <string>
+#include <vector>
+
+// A task, as exported by Taskwarrior.  Attributes are stored as strings, the
+// same way Taskwarrior stores them: tags are comma-separated in 'tags', and
+// each annotation is stored as 'annotation_<entry epoch>'.
+class Task
+{
+public:
+  Task () = default;
+
+  bool has (const std::string&) const;
+  std::string get (const std::string&) const;
+  void set (const std::string&, const std::string&);
+  const std::map <std::string, std::string>& all () const;
+
+private:
+  std::map <std::string, std::string> _data {};
+};
+
+// Parse one line of 'task export' output, in either format, as it arrives.
+// Returns false for lines that hold no task, such as the array brackets, and
+// for a line that is not valid JSON, such as one cut short, which is reported
+// on stderr, so that the rest of the export is still read.
+bool parseExportLine (const std::string&, Task&);
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
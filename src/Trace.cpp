@@ -0,0 +1,189 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <Trace.h>
+#include <unistd.h>
+#include <JSON.h>
+#include <format.h>
+
+Trace trace;
+
+// Events are written out once this much is buffered.
+static const size_t blockSize = 65536;
+
+////////////////////////////////////////////////////////////////////////////////
+Trace::~Trace ()
+{
+  close ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Trace::open (const std::string& file)
+{
+  std::lock_guard <std::mutex> lock (_mutex);
+  _file.open (file, std::ios::out | std::ios::trunc);
+  if (! _file.good ())
+    throw format ("Could not write '{1}'.", file);
+
+  _buffer.reserve (blockSize * 2);
+  _buffer = "[\n";
+  _origin = std::chrono::steady_clock::now ();
+  _active = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Trace::close ()
+{
+  std::lock_guard <std::mutex> lock (_mutex);
+  if (! _active)
+    return;
+
+  _active = false;
+  _buffer += "\n]\n";
+  _file << _buffer;
+  _file.close ();
+  _buffer = "";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool Trace::active () const
+{
+  return _active;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Trace::complete (
+  const std::string& name,
+  const char* category,
+  Time start,
+  Time end,
+  const std::string& detail /* = "" */)
+{
+  if (_active)
+    event (name, category, 'X', start, end, detail);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Trace::instant (
+  const std::string& name,
+  const char* category,
+  const std::string& detail /* = "" */)
+{
+  if (_active)
+  {
+    auto now = std::chrono::steady_clock::now ();
+    event (name, category, 'i', now, now, detail);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Timestamps are in microseconds since the trace was opened.  Threads are
+// numbered in order of appearance, the main thread first.
+void Trace::event (
+  const std::string& name,
+  const char* category,
+  char phase,
+  Time start,
+  Time end,
+  const std::string& detail)
+{
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+
+  std::lock_guard <std::mutex> lock (_mutex);
+  if (! _active)
+    return;
+
+  auto thread = _threads.find (std::this_thread::get_id ());
+  if (thread == _threads.end ())
+    thread = _threads.insert ({std::this_thread::get_id (), (int) _threads.size () + 1}).first;
+
+  if (! _first)
+    _buffer += ",\n";
+
+  _first = false;
+  _buffer += "{\"name\":\"";
+  _buffer += json::encode (name);
+  _buffer += "\",\"cat\":\"";
+  _buffer += category;
+  _buffer += "\",\"ph\":\"";
+  _buffer += phase;
+  _buffer += "\",\"pid\":";
+  _buffer += std::to_string (getpid ());
+  _buffer += ",\"tid\":";
+  _buffer += std::to_string (thread->second);
+  _buffer += ",\"ts\":";
+  _buffer += std::to_string (duration_cast <microseconds> (start - _origin).count ());
+
+  if (phase == 'X')
+  {
+    _buffer += ",\"dur\":";
+    _buffer += std::to_string (duration_cast <microseconds> (end - start).count ());
+  }
+  else
+  {
+    // Instant events are scoped to their thread.
+    _buffer += ",\"s\":\"t\"";
+  }
+
+  if (detail != "")
+  {
+    _buffer += ",\"args\":{\"detail\":\"";
+    _buffer += json::encode (detail);
+    _buffer += "\"}";
+  }
+
+  _buffer += '}';
+
+  if (_buffer.length () >= blockSize)
+  {
+    _file << _buffer;
+    _buffer.clear ();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Span::Span (const char* name, const char* category, const std::string& detail /* = "" */)
+: _name (name)
+, _category (category)
+{
+  if (trace.active ())
+  {
+    _detail = detail;
+    _start = std::chrono::steady_clock::now ();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Span::~Span ()
+{
+  if (trace.active () && _start != Trace::Time ())
+    trace.complete (_name, _category, _start, std::chrono::steady_clock::now (), _detail);
+}
+
+////////////////////////////////////////////////////////////////////////////////
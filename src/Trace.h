@@ -0,0 +1,87 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_TRACE
+#define INCLUDED_TRACE
+
+#include <string>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <fstream>
+
+// Writes Chrome trace-event JSON, as read by chrome://tracing and Perfetto.
+// Events are formatted into a buffer that is written out in large blocks, and
+// when tracing is off, recording an event costs a single flag test.
+class Trace
+{
+public:
+  typedef std::chrono::steady_clock::time_point Time;
+
+  ~Trace ();
+
+  void open (const std::string&);
+  void close ();
+  bool active () const;
+
+  void complete (const std::string&, const char*, Time, Time, const std::string& detail = "");
+  void instant (const std::string&, const char*, const std::string& detail = "");
+
+private:
+  void event (const std::string&, const char*, char, Time, Time, const std::string&);
+
+private:
+  std::atomic <bool>               _active  {false};
+  std::mutex                       _mutex   {};
+  std::ofstream                    _file    {};
+  std::string                      _buffer  {};
+  bool                             _first   {true};
+  Time                             _origin  {};
+  std::map <std::thread::id, int>  _threads {};
+};
+
+extern Trace trace;
+
+// A span that covers the lifetime of the object.
+class Span
+{
+public:
+  Span (const char*, const char*, const std::string& detail = "");
+  ~Span ();
+
+private:
+  const char*  _name;
+  const char*  _category;
+  std::string  _detail   {};
+  Trace::Time  _start    {};
+};
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
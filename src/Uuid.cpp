@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <Uuid.h>
+#include <cstring>
+#include <cstdint>
+
+static const char* digits = "0123456789abcdef";
+
+////////////////////////////////////////////////////////////////////////////////
+// Parses the canonical 8-4-4-4-12 form, in either case.
+bool Uuid::parse (const std::string& input, Uuid& uuid)
+{
+  return input.length () == 36 && pack (input, uuid, false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The lowest UUID whose text begins with the given prefix, as a starting
+// point for prefix searches of sorted UUIDs.
+bool Uuid::floor (const std::string& prefix, Uuid& uuid)
+{
+  return prefix.length () <= 36 && pack (prefix, uuid, true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Writes the 36 characters of the text form, and a terminating NUL, so the
+// buffer needs room for 37.
+void Uuid::text (char* buffer) const
+{
+  char* out = buffer;
+  for (int i = 0; i < 16; ++i)
+  {
+    if (i == 4 || i == 6 || i == 8 || i == 10)
+      *out++ = '-';
+
+    *out++ = digits[_bytes[i] >> 4];
+    *out++ = digits[_bytes[i] & 0xf];
+  }
+
+  *out = '\0';
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string Uuid::str () const
+{
+  char buffer[37];
+  text (buffer);
+  return std::string (buffer, 36);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool Uuid::startsWith (const std::string& prefix) const
+{
+  char buffer[37];
+  text (buffer);
+  return prefix.length () <= 36 &&
+         strncmp (buffer, prefix.c_str (), prefix.length ()) == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// UUIDs are mostly random, so folding the halves together is enough.
+size_t Uuid::hash () const
+{
+  uint64_t high;
+  uint64_t low;
+  memcpy (&high, _bytes,     8);
+  memcpy (&low,  _bytes + 8, 8);
+  return (size_t) (high ^ (low * 0x9e3779b97f4a7c15ULL));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool Uuid::operator== (const Uuid& other) const
+{
+  return memcmp (_bytes, other._bytes, 16) == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool Uuid::operator!= (const Uuid& other) const
+{
+  return memcmp (_bytes, other._bytes, 16) != 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool Uuid::operator< (const Uuid& other) const
+{
+  return memcmp (_bytes, other._bytes, 16) < 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Dashes must be where the canonical form has them, and everything else a hex
+// digit.  Digits not given, when partial, are zero.
+bool Uuid::pack (const std::string& input, Uuid& uuid, bool partial)
+{
+  Uuid result;
+  int nibble = 0;
+  for (size_t i = 0; i < input.length (); ++i)
+  {
+    char c = input[i];
+    if (i == 8 || i == 13 || i == 18 || i == 23)
+    {
+      if (c != '-')
+        return false;
+
+      continue;
+    }
+
+    int value;
+         if (c >= '0' && c <= '9') value = c - '0';
+    else if (c >= 'a' && c <= 'f') value = c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F') value = c - 'A' + 10;
+    else                           return false;
+
+    result._bytes[nibble / 2] |= (unsigned char) (nibble % 2 ? value : value << 4);
+    ++nibble;
+  }
+
+  if (! partial && nibble != 32)
+    return false;
+
+  uuid = result;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,71 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_UUID
+#define INCLUDED_UUID
+
+#include <string>
+#include <functional>
+#include <cstddef>
+
+// A UUID packed into 16 bytes, parsed and validated once, and formatted only
+// when needed.  Ordering matches that of the lower-case text form.
+class Uuid
+{
+public:
+  Uuid () = default;
+
+  static bool parse (const std::string&, Uuid&);
+  static bool floor (const std::string&, Uuid&);
+
+  void text (char*) const;
+  std::string str () const;
+  bool startsWith (const std::string&) const;
+  size_t hash () const;
+
+  bool operator== (const Uuid&) const;
+  bool operator!= (const Uuid&) const;
+  bool operator<  (const Uuid&) const;
+
+private:
+  static bool pack (const std::string&, Uuid&, bool);
+
+private:
+  unsigned char _bytes[16] {};
+};
+
+namespace std
+{
+  template <> struct hash <Uuid>
+  {
+    size_t operator() (const Uuid& uuid) const { return uuid.hash (); }
+  };
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
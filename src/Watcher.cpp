@@ -0,0 +1,272 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <Watcher.h>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <Config.h>
+#include <process.h>
+#include <format.h>
+
+#ifdef LINUX
+#include <sys/inotify.h>
+#endif
+
+Watcher watcher;
+
+// The files that make up a Taskwarrior database.
+static const std::vector <std::string> dataFiles {
+  "pending.data",
+  "completed.data",
+  "undo.data",
+  "backlog.data",
+};
+
+////////////////////////////////////////////////////////////////////////////////
+std::string fileSignature (const std::string& path)
+{
+  struct stat s;
+  if (stat (path.c_str (), &s) == -1)
+    return "-";
+
+#if defined (DARWIN)
+  auto nsec = s.st_mtimespec.tv_nsec;
+#else
+  auto nsec = s.st_mtim.tv_nsec;
+#endif
+
+  return format ("{1}:{2}:{3}:{4}", s.st_ino, s.st_size, s.st_mtime, nsec);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static void splitPath (
+  const std::string& path,
+  std::string& directory,
+  std::string& name)
+{
+  auto slash = path.rfind ('/');
+  if (slash == std::string::npos)
+  {
+    directory = ".";
+    name = path;
+  }
+  else
+  {
+    directory = slash ? path.substr (0, slash) : "/";
+    name = path.substr (slash + 1);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Watcher::~Watcher ()
+{
+  stop ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Directories are watched, rather than files, so that files that are replaced
+// by rename, as editors do with .taskrc, continue to be followed.
+void Watcher::start ()
+{
+#ifdef LINUX
+  if (_watching)
+    return;
+
+  _dataDir = config.dataLocation ();
+  splitPath (config.file (), _configDir, _configName);
+
+  _fd = inotify_init ();
+  if (_fd == -1)
+    return;
+
+  fcntl (_fd, F_SETFD, FD_CLOEXEC);
+
+  const uint32_t events = IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE |
+                          IN_DELETE | IN_MOVED_FROM  | IN_MOVED_TO;
+  _dataWatch   = inotify_add_watch (_fd, _dataDir.c_str (),   events);
+  _configWatch = inotify_add_watch (_fd, _configDir.c_str (), events);
+
+  if (_dataWatch == -1 || _configWatch == -1 || pipe (_wake) == -1)
+  {
+    close (_fd);
+    _fd = -1;
+    return;
+  }
+
+  fcntl (_wake[0], F_SETFD, FD_CLOEXEC);
+  fcntl (_wake[1], F_SETFD, FD_CLOEXEC);
+
+  _watching = true;
+  _thread = std::thread (&Watcher::run, this);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Watcher::stop ()
+{
+  if (! _watching)
+    return;
+
+  char c = 0;
+  if (write (_wake[1], &c, 1) == 1)
+    _thread.join ();
+  else
+    _thread.detach ();
+
+  close (_wake[0]);
+  close (_wake[1]);
+  close (_fd);
+  _fd = -1;
+  _watching = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool Watcher::watching () const
+{
+  return _watching;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned long Watcher::dataGeneration ()
+{
+  if (! _watching)
+  {
+    // Obtaining the signature may itself poll the configuration.
+    auto signature = dataSignature ();
+    std::lock_guard <std::mutex> lock (_mutex);
+    if (signature != _dataPolled)
+    {
+      _dataPolled = signature;
+      ++_data;
+    }
+  }
+
+  return _data;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned long Watcher::configGeneration ()
+{
+  if (! _watching)
+  {
+    auto signature = configSignature ();
+    std::lock_guard <std::mutex> lock (_mutex);
+    if (signature != _configPolled)
+    {
+      _configPolled = signature;
+      ++_config;
+    }
+  }
+
+  return _config;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Watcher::run ()
+{
+  blockInterrupts ();
+
+#ifdef LINUX
+  char buffer[4096] __attribute__ ((aligned (__alignof__ (struct inotify_event))));
+
+  struct pollfd fds[2];
+  fds[0].fd = _fd;
+  fds[0].events = POLLIN;
+  fds[1].fd = _wake[0];
+  fds[1].events = POLLIN;
+
+  while (true)
+  {
+    if (poll (fds, 2, -1) == -1)
+    {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+
+    if (fds[1].revents)
+      break;
+
+    auto got = read (_fd, buffer, sizeof (buffer));
+    if (got <= 0)
+      continue;
+
+    for (char* p = buffer; p < buffer + got; )
+    {
+      auto event = (struct inotify_event*) p;
+      p += sizeof (struct inotify_event) + event->len;
+
+      std::string name = event->len ? event->name : "";
+
+      if (event->wd == _configWatch && name == _configName)
+        ++_config;
+
+      if (event->wd == _dataWatch)
+        for (auto& file : dataFiles)
+          if (name == file)
+            ++_data;
+
+      // Overflow means events were lost, so assume everything changed.
+      if (event->mask & IN_Q_OVERFLOW)
+      {
+        ++_config;
+        ++_data;
+      }
+    }
+  }
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string Watcher::dataSignature () const
+{
+  return dataSignature (config.dataLocation ());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Needs no configuration, so it may be used from any thread.
+std::string Watcher::dataSignature (const std::string& location) const
+{
+  std::string signature;
+  for (auto& file : dataFiles)
+    signature += fileSignature (location + "/" + file) + " ";
+
+  return signature;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string Watcher::configSignature () const
+{
+  return fileSignature (config.file ());
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,89 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_WATCHER
+#define INCLUDED_WATCHER
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+// Publishes changes to the Taskwarrior data files and .taskrc as generation
+// numbers, which increase whenever the files change, for whatever reason.
+// Caches remember the generation they were built for, and compare.
+//
+// On Linux, a background thread follows inotify events.  Elsewhere, or if
+// inotify is unavailable, the files are polled with stat when a generation is
+// requested.
+class Watcher
+{
+public:
+  Watcher () = default;
+  ~Watcher ();
+
+  void start ();
+  void stop ();
+  bool watching () const;
+
+  unsigned long dataGeneration ();
+  unsigned long configGeneration ();
+  std::string dataSignature () const;
+  std::string dataSignature (const std::string&) const;
+
+private:
+  void run ();
+  std::string configSignature () const;
+
+private:
+  std::atomic <unsigned long> _data          {1};
+  std::atomic <unsigned long> _config        {1};
+  std::thread                 _thread        {};
+  bool                        _watching      {false};
+  int                         _fd            {-1};
+  int                         _wake[2]       {-1, -1};
+  int                         _dataWatch     {-1};
+  int                         _configWatch   {-1};
+  std::string                 _dataDir       {};
+  std::string                 _configDir     {};
+  std::string                 _configName    {};
+
+  // Polling state.
+  std::mutex                  _mutex         {};
+  std::string                 _dataPolled    {};
+  std::string                 _configPolled  {};
+};
+
+extern Watcher watcher;
+
+// Returns "inode:size:mtime" for a file, or "-" if it does not exist.
+std::string fileSignature (const std::string&);
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
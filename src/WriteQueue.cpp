@@ -0,0 +1,404 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <WriteQueue.h>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <Executor.h>
+#include <process.h>
+#include <Trace.h>
+#include <Lexer.h>
+#include <format.h>
+#include <shared.h>
+
+////////////////////////////////////////////////////////////////////////////////
+WriteQueue::~WriteQueue ()
+{
+  drain ();
+
+  if (_worker.joinable ())
+  {
+    {
+      std::lock_guard <std::mutex> lock (_mutex);
+      _stop = true;
+    }
+
+    _changed.notify_all ();
+    _worker.join ();
+  }
+
+  if (_journal != -1)
+    close (_journal);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A batch size of 0 or 1 writes every action immediately.
+void WriteQueue::batchSize (unsigned int size)
+{
+  _batchSize = size;
+  if (_writes.size () >= _batchSize)
+    flush ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Writes from now on are made by a worker thread, and journaled in the given
+// file.  Mutations left in the journal by an earlier session are queued first,
+// and their number is given.  If the journal cannot be opened, or another
+// session holds it, writes remain synchronous, and false is returned.
+bool WriteQueue::background (const std::string& file, unsigned int& recovered)
+{
+  recovered = 0;
+  if (_worker.joinable ())
+    return true;
+
+  _journal = open (file.c_str (), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+  if (_journal == -1)
+    return false;
+
+  if (flock (_journal, LOCK_EX | LOCK_NB) == -1)
+  {
+    close (_journal);
+    _journal = -1;
+    return false;
+  }
+
+  _todo = recover (file);
+  recovered = _todo.size ();
+  _worker = std::thread (&WriteQueue::worker, this);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// True if writing the action again, after it was already written, changes
+// nothing more.  A new 'reviewed' date is only a moment later.
+static bool idempotent (const std::vector <std::string>& action)
+{
+  static const std::vector <std::vector <std::string>> actions {
+    {"modify", "reviewed:now"},
+    {"done"},
+    {"delete"},
+  };
+
+  return std::find (actions.begin (), actions.end (), action) != actions.end ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void WriteQueue::add (
+  const Uuid& uuid,
+  const std::vector <std::string>& action)
+{
+  Write write {uuid, action, 0};
+
+  // Replaying it might apply it twice, so it is not journaled, but written
+  // now, after everything before it, so that it is never left to replay.
+  if (_journal != -1 &&
+      ! idempotent (action))
+  {
+    drain ();
+    this->write ({write});
+    return;
+  }
+
+  // Journaled before anything else happens to it.
+  if (_journal != -1)
+  {
+    write.sequence = ++_sequence;
+    record (format ("+{1} {2} {3}\n", write.sequence, uuid.str (), join ("\x1f", action)));
+  }
+
+  _writes.push_back (write);
+  if (_writes.size () >= _batchSize)
+    flush ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Hands buffered writes to the worker, or writes them here if there is none.
+void WriteQueue::flush ()
+{
+  if (_writes.size () == 0)
+    return;
+
+  if (_worker.joinable ())
+  {
+    {
+      std::lock_guard <std::mutex> lock (_mutex);
+      _todo.insert (_todo.end (), _writes.begin (), _writes.end ());
+    }
+
+    _changed.notify_all ();
+  }
+  else
+    write (_writes);
+
+  _writes.clear ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Waits until everything added is written.  The journal is then empty.
+void WriteQueue::drain ()
+{
+  flush ();
+  if (! _worker.joinable ())
+    return;
+
+  Span span ("review.drain", "review");
+  std::unique_lock <std::mutex> lock (_mutex);
+  _changed.wait (lock, [this] { return _todo.size () == 0 && _writing.size () == 0; });
+
+  if (_journal != -1 &&
+      ftruncate (_journal, 0) == -1)
+    _failures.push_back ("Could not empty the journal.");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Waits for any write to the task, before it is changed some other way.
+void WriteQueue::wait (const Uuid& uuid)
+{
+  auto matches = [&uuid] (const Write& write) { return write.uuid == uuid; };
+
+  bool queued;
+  {
+    std::lock_guard <std::mutex> lock (_mutex);
+    queued = std::any_of (_writes.begin (),  _writes.end (),  matches) ||
+             std::any_of (_todo.begin (),    _todo.end (),    matches) ||
+             std::any_of (_writing.begin (), _writing.end (), matches);
+  }
+
+  if (queued)
+    drain ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Buffered, queued and in-progress writes.
+unsigned int WriteQueue::pending () const
+{
+  std::lock_guard <std::mutex> lock (_mutex);
+  return _writes.size () + _todo.size () + _writing.size ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Failures since last asked.
+std::vector <std::string> WriteQueue::failures ()
+{
+  std::lock_guard <std::mutex> lock (_mutex);
+  std::vector <std::string> failures;
+  failures.swap (_failures);
+  return failures;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Writes made without failure since last asked.
+unsigned int WriteQueue::succeeded ()
+{
+  std::lock_guard <std::mutex> lock (_mutex);
+  auto succeeded = _succeeded;
+  _succeeded = 0;
+  return succeeded;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Must be set before anything is written.  It is called from the worker, so it
+// must be safe to call from any thread.
+void WriteQueue::signature (std::function <std::string ()> signature)
+{
+  _signature = signature;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Taskwarrior runs since last asked, in order.
+std::vector <WriteQueue::Written> WriteQueue::written ()
+{
+  std::lock_guard <std::mutex> lock (_mutex);
+  std::vector <Written> written;
+  written.swap (_written);
+  return written;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Writes are grouped by action, in order of first appearance.  Relative order
+// is preserved for any given task.
+void WriteQueue::write (std::vector <Write> writes)
+{
+  Span span ("review.write", "review");
+  while (writes.size ())
+  {
+    auto action = writes[0].action;
+
+    std::vector <std::string> args {"rc.confirmation:no", "rc.verbose:nothing", "rc.bulk:0"};
+    std::vector <Write> deferred;
+    std::vector <Write> written;
+    for (auto& write : writes)
+    {
+      // A task with an earlier, deferred write must wait for it.
+      auto blocked = std::find_if (deferred.begin (), deferred.end (),
+                                   [&write] (const Write& w) { return w.uuid == write.uuid; })
+                     != deferred.end ();
+
+      if (write.action == action && ! blocked)
+      {
+        args.push_back (write.uuid.str ());
+        written.push_back (write);
+      }
+      else
+        deferred.push_back (write);
+    }
+
+    args.insert (args.end (), action.begin (), action.end ());
+
+    // Output is collected, so that it does not interrupt the review.
+    Written run;
+    if (_signature)
+      run.before = _signature ();
+
+    std::string output;
+    std::string errors;
+    auto status = executor ().collect ("task", args, output, errors);
+
+    if (_signature)
+    {
+      run.after = _signature ();
+      for (auto& write : written)
+        run.uuids.push_back (write.uuid);
+
+      std::lock_guard <std::mutex> lock (_mutex);
+      _written.push_back (run);
+    }
+
+    {
+      std::lock_guard <std::mutex> lock (_mutex);
+      if (status)
+        _failures.push_back (format ("Could not write '{1}' to {2} task(s): {3}",
+                                     join (" ", action),
+                                     written.size (),
+                                     Lexer::trim (errors + output, " \t\n")));
+      else
+        _succeeded += written.size ();
+    }
+
+    // Failures are struck off too, because retrying would fail again.
+    if (_journal != -1)
+      for (auto& write : written)
+        if (write.sequence)
+          record (format ("-{1}\n", write.sequence));
+
+    writes = deferred;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void WriteQueue::worker ()
+{
+  blockInterrupts ();
+
+  std::unique_lock <std::mutex> lock (_mutex);
+  while (true)
+  {
+    _changed.wait (lock, [this] { return _stop || _todo.size (); });
+    if (_todo.size () == 0)
+      return;
+
+    _writing.swap (_todo);
+
+    lock.unlock ();
+    write (_writing);
+    lock.lock ();
+
+    _writing.clear ();
+    _changed.notify_all ();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Each entry is appended by one write (2), so that entries from this thread
+// and the worker never interleave.  New mutations are then synced, so that
+// they also survive the system crashing.  Strike-offs are not, because losing
+// one only means that a mutation that can be repeated is written again.
+void WriteQueue::record (const std::string& entry)
+{
+  bool recorded = ::write (_journal, entry.data (), entry.length ()) == (ssize_t) entry.length ();
+
+#if defined (DARWIN)
+  if (recorded && entry[0] == '+')
+    recorded = fsync (_journal) == 0;
+#else
+  if (recorded && entry[0] == '+')
+    recorded = fdatasync (_journal) == 0;
+#endif
+
+  if (! recorded)
+  {
+    std::lock_guard <std::mutex> lock (_mutex);
+    _failures.push_back ("Could not write to the journal.");
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Journal entries are '+<sequence> <uuid> <action>', with the words of the
+// action separated by \x1f, and '-<sequence>' once written.  A partial last
+// line, from a crash while it was written, is ignored.
+std::vector <WriteQueue::Write> WriteQueue::recover (const std::string& file)
+{
+  std::ifstream in (file, std::ios::binary);
+  std::string contents ((std::istreambuf_iterator <char> (in)), std::istreambuf_iterator <char> ());
+
+  std::map <unsigned long, Write> outstanding;
+  std::string::size_type start = 0;
+  std::string::size_type end;
+  while ((end = contents.find ('\n', start)) != std::string::npos)
+  {
+    auto line = contents.substr (start, end - start);
+    start = end + 1;
+
+    auto sequence = strtoul (line.c_str () + 1, NULL, 10);
+    _sequence = std::max (_sequence, sequence);
+
+    Uuid uuid;
+    auto space = line.find (' ');
+    if (line[0] == '-')
+      outstanding.erase (sequence);
+    else if (line[0] == '+' &&
+             space != std::string::npos &&
+             Uuid::parse (line.substr (space + 1, 36), uuid) &&
+             line.length () > space + 38)
+      outstanding[sequence] = {uuid, split (line.substr (space + 38), '\x1f'), sequence};
+  }
+
+  std::vector <Write> writes;
+  for (auto& write : outstanding)
+    writes.push_back (write.second);
+
+  return writes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_WRITEQUEUE
+#define INCLUDED_WRITEQUEUE
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <Uuid.h>
+
+// Buffers task mutations, and writes them with as few Taskwarrior invocations
+// as possible: all tasks sharing the same action are written by one command,
+// for example 'task <uuid1> <uuid2> ... modify reviewed:now'.
+//
+// In the background, a worker thread does the writing, so that the caller
+// need not wait for Taskwarrior and its hooks.  Writes to any one task keep
+// their order, and failures are kept for the caller to report.
+//
+// Each mutation is appended to a journal, and synced to disk, before it is
+// queued, and struck off once written, so that mutations a crashed session
+// never wrote are written by the next.  A crash after Taskwarrior wrote a
+// mutation, but before it was struck off, means it is written again, so only
+// mutations that have the same effect when repeated are journaled: marking a
+// task reviewed, completing it and deleting it.  Any other modification is
+// written before add returns, once earlier writes are done, and is never
+// replayed.
+//
+// Given a way to obtain the data signature, each Taskwarrior run is recorded
+// with the signatures before and after, so that the caller can tell its own
+// changes from those of others.
+class WriteQueue
+{
+public:
+  struct Written
+  {
+    std::vector <Uuid> uuids;
+    std::string        before;
+    std::string        after;
+  };
+
+  WriteQueue () = default;
+  ~WriteQueue ();
+
+  void batchSize (unsigned int);
+  bool background (const std::string&, unsigned int&);
+  void add (const Uuid&, const std::vector <std::string>&);
+  void flush ();
+  void drain ();
+  void wait (const Uuid&);
+  unsigned int pending () const;
+  std::vector <std::string> failures ();
+  unsigned int succeeded ();
+  void signature (std::function <std::string ()>);
+  std::vector <Written> written ();
+
+private:
+  struct Write
+  {
+    Uuid                      uuid;
+    std::vector <std::string> action;
+    unsigned long             sequence;
+  };
+
+  void write (std::vector <Write>);
+  void worker ();
+  void record (const std::string&);
+  std::vector <Write> recover (const std::string&);
+
+  std::vector <Write>             _writes    {};
+  unsigned int                    _batchSize {1};
+
+  std::thread                     _worker    {};
+  mutable std::mutex              _mutex     {};
+  std::condition_variable         _changed   {};
+  std::vector <Write>             _todo      {};
+  std::vector <Write>             _writing   {};
+  std::vector <std::string>       _failures  {};
+  unsigned int                    _succeeded {0};
+  std::vector <Written>           _written   {};
+  std::function <std::string ()>  _signature {};
+  bool                            _stop      {false};
+
+  int                             _journal   {-1};
+  unsigned long                   _sequence  {0};
+};
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
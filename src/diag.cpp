@@ -35,6 +35,7 @@
 #include <Color.h>
 #include <shared.h>
 #include <format.h>
+#include <Executor.h>
 
 #ifdef HAVE_READLINE
 #include <readline/readline.h>
@@ -145,9 +146,8 @@ int cmdDiagnostics ()
     File task (i + "/task");
     if (task.exists ())
     {
-      std::string input;
       std::string output;
-      execute ("task", {"--version"}, input, output);
+      executor ().capture ("task", {"--version"}, output);
 
       std::cout << "Taskwarrior: "
                 << i
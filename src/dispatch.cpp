@@ -0,0 +1,443 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <dispatch.h>
+#include <iostream>
+#include <algorithm>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <Config.h>
+#include <ResultCache.h>
+#include <Executor.h>
+#include <process.h>
+#include <Trace.h>
+#include <shared.h>
+#include <format.h>
+
+// Built-in commands that do not modify data.  Custom reports are added from
+// the configuration.
+static const std::vector <std::string> readOnlyCommands {
+  "active", "all", "blocked", "blocking", "burndown", "burndown.daily",
+  "burndown.monthly", "burndown.weekly", "calendar", "colors", "columns",
+  "commands", "completed", "count", "diagnostics", "export", "ghistory",
+  "ghistory.annual", "ghistory.monthly", "help", "history", "history.annual",
+  "history.monthly", "ids", "information", "list", "long", "ls", "minimal",
+  "newest", "next", "oldest", "overdue", "projects", "ready", "recurring",
+  "reports", "show", "stats", "summary", "tags", "timesheet", "udas",
+  "unblocked", "uuids", "version", "waiting",
+};
+
+// Built-in commands that modify data, or configuration.
+static const std::vector <std::string> writeCommands {
+  "add", "annotate", "append", "config", "context", "delete", "denotate",
+  "done", "duplicate", "edit", "execute", "import", "log", "modify", "prepend",
+  "purge", "start", "stop", "synchronize", "undo",
+};
+
+// Number of commands run with garbage collection suppressed.
+static unsigned int gcAvoided = 0;
+
+// Output of recent read-only commands.
+static ResultCache cache;
+
+////////////////////////////////////////////////////////////////////////////////
+static bool isReport (const std::string& name)
+{
+  return config.has ("report." + name + ".columns");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Exact matches win, otherwise an unambiguous abbreviation of at least
+// rc.abbreviation.minimum characters is accepted, as Taskwarrior does.
+static std::string canonical (const std::string& word)
+{
+  // Helper commands, such as '_get', are never abbreviated.
+  if (word.length () && word[0] == '_')
+    return word;
+
+  if (isReport (word) ||
+      std::find (readOnlyCommands.begin (), readOnlyCommands.end (), word) != readOnlyCommands.end () ||
+      std::find (writeCommands.begin (),    writeCommands.end (),    word) != writeCommands.end ())
+    return word;
+
+  unsigned int minimum = config.getInteger ("abbreviation.minimum", 2);
+  if (word.length () < minimum)
+    return "";
+
+  std::vector <std::string> candidates;
+  for (auto list : {&readOnlyCommands, &writeCommands})
+    for (auto& command : *list)
+      if (command.compare (0, word.length (), word) == 0)
+        candidates.push_back (command);
+
+  return candidates.size () == 1 ? candidates[0] : "";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string commandName (const std::vector <std::string>& args)
+{
+  for (auto& arg : args)
+  {
+    // Skip overrides and filter terms that cannot be commands.
+    if (arg.compare (0, 3, "rc.") == 0 ||
+        arg.compare (0, 3, "rc:") == 0 ||
+        arg.find_first_of (":=+-/()") != std::string::npos)
+      continue;
+
+    // An alias stands for the first word of its expansion.
+    auto alias = config.get ("alias." + arg);
+    if (alias != "")
+    {
+      auto expansion = split (alias, ' ');
+      if (expansion.size ())
+        return canonical (expansion[0]);
+    }
+
+    auto name = canonical (arg);
+    if (name != "")
+      return name;
+  }
+
+  return "";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool isReadOnly (const std::vector <std::string>& args)
+{
+  auto name = commandName (args);
+  if (name == "")
+    return false;
+
+  // 'context' lists contexts, but also sets them.
+  if (name == "context")
+    return false;
+
+  // Helper commands, such as '_get', only read.
+  if (name[0] == '_')
+    return true;
+
+  return isReport (name) ||
+         std::find (readOnlyCommands.begin (), readOnlyCommands.end (), name) != readOnlyCommands.end ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The command line to run, with garbage collection suppressed if it is
+// deferred.
+static std::vector <std::string> deferGC (const std::vector <std::string>& args)
+{
+  auto command = args;
+
+  bool overridden = std::find_if (args.begin (), args.end (), [] (const std::string& arg) {
+                      return arg.compare (0, 6, "rc.gc=") == 0 ||
+                             arg.compare (0, 6, "rc.gc:") == 0;
+                    }) != args.end ();
+
+  if (! overridden                          &&
+      config.getBoolean ("tasksh.gc.defer") &&
+      config.getBoolean ("gc")              &&
+      isReadOnly (args))
+  {
+    command.insert (command.begin (), "rc.gc=off");
+    ++gcAvoided;
+
+    // Recurring task instances are only generated by reports, so it is
+    // harmless to skip that for helper commands.
+    if (commandName (args)[0] == '_')
+      command.insert (command.begin (), "rc.recurrence=off");
+  }
+
+  return command;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The command line as the cache sees it, so that lines that mean the same
+// thing share an entry: the Taskwarrior command, resolved from any alias or
+// abbreviation, then the overrides, by name, and then everything else.  The
+// filter terms of a report are combined with 'and', so their order does not
+// matter, unless there are operators or parentheses.
+static std::vector <std::string> cacheArgs (const std::vector <std::string>& args)
+{
+  auto name = commandName (args);
+
+  std::map <std::string, std::string> overrides;
+  std::vector <std::string> rest;
+  bool found = false;
+  for (auto& arg : args)
+  {
+    if (arg.compare (0, 3, "rc.") == 0 ||
+        arg.compare (0, 3, "rc:") == 0)
+    {
+      auto separator = arg.find_first_of ("=:", 2);
+      overrides[arg.substr (0, separator)] = separator == std::string::npos ? "" : arg.substr (separator + 1);
+    }
+    else if (! found && commandName ({arg}) == name)
+    {
+      found = true;
+
+      // An alias brings the rest of its expansion with it.
+      auto alias = config.get ("alias." + arg);
+      if (alias != "")
+      {
+        auto expansion = split (alias, ' ');
+        rest.insert (rest.end (), expansion.begin () + 1, expansion.end ());
+      }
+    }
+    else
+      rest.push_back (arg);
+  }
+
+  bool ordered = std::find_if (rest.begin (), rest.end (), [] (const std::string& word) {
+                   return word == "or" || word == "xor" || word == "and" ||
+                          word.find_first_of ("()") != std::string::npos;
+                 }) != rest.end ();
+
+  if (isReport (name) && ! ordered)
+    std::sort (rest.begin (), rest.end ());
+
+  std::vector <std::string> canonical {name};
+  for (auto& override : overrides)
+    canonical.push_back (override.first + '=' + override.second);
+
+  canonical.insert (canonical.end (), rest.begin (), rest.end ());
+  return canonical;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// With rc.tasksh.cache, the output of read-only commands is replayed when the
+// same command is repeated over unchanged data.
+//
+// With rc.tasksh.gc.defer, read-only commands are run with rc.gc=off, so they
+// do not rewrite the data files.  Taskwarrior only collects garbage, and
+// renumbers IDs, before commands that display IDs, so writes never trigger it
+// either, and the IDs the user sees remain valid for the whole session.
+// Garbage is then collected once, by deferredGC, when the session ends.
+int cmdTask (const std::vector <std::string>& args)
+{
+  auto command = deferGC (args);
+
+  std::cout << std::flush;
+
+  if (config.getBoolean ("tasksh.cache"))
+  {
+    // Any write may invalidate everything.
+    if (! isReadOnly (args))
+    {
+      cache.clear ();
+    }
+
+    // Only output to a terminal is cached, as that is where repetition is.
+    else
+    {
+      struct winsize size;
+      if (isatty (STDOUT_FILENO) &&
+          ioctl (STDOUT_FILENO, TIOCGWINSZ, &size) != -1)
+      {
+        cache.ttl (config.getInteger ("tasksh.cache.ttl", 60));
+
+        auto key = ResultCache::key (cacheArgs (args), size.ws_col);
+
+        std::string output;
+        if (cache.lookup (key, output))
+        {
+          trace.instant ("cache.hit", "cache");
+          std::cout << output << std::flush;
+          return 0;
+        }
+
+        trace.instant ("cache.miss", "cache");
+
+        // Output is shown as it arrives, but stops being captured once it is
+        // too large to cache.
+        auto status = executor ().runPty ("task", command, size.ws_col, size.ws_row, output, ResultCache::maxOutput);
+
+        // Keyed on the state after the command, which may have collected
+        // garbage.
+        if (status == 0)
+          cache.store (ResultCache::key (cacheArgs (args), size.ws_col), output);
+
+        return status;
+      }
+    }
+  }
+
+  return executor ().run ("task", command);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Taskwarrior collects garbage, and generates recurring task instances, before
+// reports and other commands that display IDs.  Helper commands, and these,
+// do neither.  Anything unknown is assumed to do both.
+static bool collectsGarbage (const std::vector <std::string>& args)
+{
+  static const std::vector <std::string> quiet {
+    "colors", "columns", "commands", "count", "diagnostics", "help", "reports",
+    "show", "udas", "version",
+  };
+
+  auto name = commandName (args);
+  return name == "" ||
+         (name[0] != '_' &&
+          std::find (quiet.begin (), quiet.end (), name) == quiet.end ());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Runs commands [first, last) on up to the given number of threads, and emits
+// each result as soon as it, and every result before it, is complete.
+static void runTogether (
+  const std::vector <std::vector <std::string>>& commands,
+  size_t first,
+  size_t last,
+  unsigned int jobs,
+  std::function <void (size_t, const std::string&, const std::string&)> emit)
+{
+  if (first == last)
+    return;
+
+  struct Result
+  {
+    bool        done;
+    std::string output;
+    std::string errors;
+  };
+
+  std::vector <Result> results (commands.size (), {false, "", ""});
+  std::mutex mutex;
+  std::condition_variable finished;
+  size_t next = first;
+
+  auto worker = [&] ()
+  {
+    blockInterrupts ();
+
+    while (true)
+    {
+      size_t index;
+      {
+        std::lock_guard <std::mutex> lock (mutex);
+        if (next == last)
+          return;
+
+        index = next++;
+      }
+
+      Result result {true, "", ""};
+      executor ().collect ("task", commands[index], result.output, result.errors);
+
+      {
+        std::lock_guard <std::mutex> lock (mutex);
+        results[index] = std::move (result);
+      }
+
+      finished.notify_all ();
+    }
+  };
+
+  std::vector <std::thread> workers;
+  for (unsigned int i = 0; i < std::max (jobs, 1u) && i < last - first; ++i)
+    workers.push_back (std::thread (worker));
+
+  for (size_t i = first; i < last; ++i)
+  {
+    std::unique_lock <std::mutex> lock (mutex);
+    finished.wait (lock, [&results, i] { return results[i].done; });
+    auto result = std::move (results[i]);
+    lock.unlock ();
+
+    emit (i, result.output, result.errors);
+  }
+
+  for (auto& thread : workers)
+    thread.join ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The first command of the group that collects garbage, or generates recurring
+// tasks, is run on its own, once every command before it has finished, so that
+// those see the data as it was, and those after it see the data as it leaves
+// it.  The commands before it run concurrently, as they are, and the commands
+// after it run concurrently with both disabled, so that none of them write to
+// the data files.
+void cmdTasks (
+  const std::vector <std::vector <std::string>>& lines,
+  unsigned int jobs,
+  std::function <void (size_t, const std::string&, const std::string&)> emit)
+{
+  size_t leader = 0;
+  while (leader < lines.size () && ! collectsGarbage (lines[leader]))
+    ++leader;
+
+  // Prepared here, as deferGC is not for use from other threads.
+  std::vector <std::vector <std::string>> commands;
+  for (size_t i = 0; i < lines.size (); ++i)
+  {
+    if (i <= leader)
+    {
+      commands.push_back (deferGC (lines[i]));
+    }
+    else
+    {
+      commands.push_back (lines[i]);
+      commands.back ().insert (commands.back ().begin (), {"rc.gc=off", "rc.recurrence=off"});
+    }
+  }
+
+  runTogether (commands, 0, leader, jobs, emit);
+
+  if (leader == lines.size ())
+    return;
+
+  std::string output;
+  std::string errors;
+  executor ().collect ("task", commands[leader], output, errors);
+  emit (leader, output, errors);
+
+  runTogether (commands, leader + 1, lines.size (), jobs, emit);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void deferredGC ()
+{
+  if (gcAvoided == 0)
+    return;
+
+  // 'next' is always defined, and displays IDs, so it triggers garbage
+  // collection.  The output is not needed.
+  std::string output;
+  executor ().capture ("task", {"rc.gc=on", "rc.verbose=nothing", "next", "limit:1"}, output);
+
+  if (isatty (STDIN_FILENO))
+    std::cout << format ("Deferred garbage collection avoided {1} runs.", gcAvoided) << "\n";
+
+  gcAvoided = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
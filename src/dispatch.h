@@ -0,0 +1,59 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_DISPATCH
+#define INCLUDED_DISPATCH
+
+#include <string>
+#include <vector>
+#include <functional>
+
+// Identify the Taskwarrior command in a command line, resolving aliases and
+// abbreviations.  Returns "" if there is no recognizable command.
+std::string commandName (const std::vector <std::string>&);
+
+// True if the command line only reads data.  Unrecognized commands are assumed
+// to modify data.
+bool isReadOnly (const std::vector <std::string>&);
+
+// Run a Taskwarrior command line from the shell.
+int cmdTask (const std::vector <std::string>&);
+
+// Run a group of read-only command lines concurrently, on up to the given
+// number of threads, and pass the output and errors of each to the callback,
+// in the original order.  The executor may run fewer at once.  Each sees the
+// data as it would if they had been run one at a time.
+void cmdTasks (const std::vector <std::vector <std::string>>&,
+               unsigned int,
+               std::function <void (size_t, const std::string&, const std::string&)>);
+
+// Perform any garbage collection that was deferred during the session.
+void deferredGC ();
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
@@ -34,11 +34,16 @@ int cmdHelp ()
             << "  Commands:\n"
             << "    tasksh> list             Or any other Taskwarrior command\n"
             << "    tasksh> review [N]       Task review session, with optional cutoff after N tasks\n"
+            << "    tasksh> review bulk [N]  Task review session, a page of tasks at a time\n"
             << "    tasksh> exec ls -al      Any shell command.  May also use '!ls -al'\n"
             << "    tasksh> help             Tasksh help\n"
             << "    tasksh> diagnostics      Tasksh diagnostics\n"
+            << "    tasksh> stats            Time and resources used by commands this session\n"
             << "    tasksh> quit             End of session. May also use 'exit'\n"
             << '\n'
+            << "  Prefix a command with 'task' to run Taskwarrior's command of the same\n"
+            << "  name instead, as in 'task help' or 'task stats'.\n"
+            << '\n'
             << "Run 'man tasksh' from your shell prompt.\n"
             << "Run '! man tasksh' from inside tasksh.\n"
             << '\n';
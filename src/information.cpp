@@ -0,0 +1,215 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <string>
+#include <vector>
+#include <ctime>
+#include <cctype>
+#include <cstdlib>
+#include <Task.h>
+#include <Table.h>
+#include <Color.h>
+#include <Datetime.h>
+#include <Duration.h>
+#include <shared.h>
+#include <format.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Taskwarrior dates are exported as 'YYYYMMDDTHHMMSSZ'.
+static bool isDate (const std::string& value)
+{
+  return value.length () == 16 &&
+         value[8]  == 'T'      &&
+         value[15] == 'Z';
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static std::string formatDate (const std::string& value, bool age = false)
+{
+  try
+  {
+    Datetime date (value);
+    auto formatted = date.toString ("Y-M-D H:N:S");
+    if (age)
+      formatted += " (" + Duration (Datetime () - date).formatVague () + ")";
+
+    return formatted;
+  }
+
+  catch (...)
+  {
+    return value;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static std::string capitalize (const std::string& value)
+{
+  auto result = value;
+  if (result.length ())
+    result[0] = toupper (result[0]);
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Renders the equivalent of 'task <uuid> information' from exported data,
+// without running Taskwarrior.
+std::string renderInformation (const Task& task, unsigned int width, bool color)
+{
+  Table view;
+  view.width (width ? width : 80);
+  view.add ("Name");
+  view.add ("Value");
+  if (color)
+    view.colorHeader (Color ("underline"));
+
+  auto row = [&view] (const std::string& name, const std::string& value)
+  {
+    auto r = view.addRow ();
+    view.set (r, 0, name);
+    view.set (r, 1, value);
+  };
+
+  if (task.get ("id") != "" && task.get ("id") != "0")
+    row ("ID", task.get ("id"));
+
+  // The description is followed by the annotations.
+  auto description = task.get ("description");
+  for (auto& attribute : task.all ())
+    if (attribute.first.compare (0, 11, "annotation_") == 0)
+      description += "\n  "
+                   + Datetime (strtol (attribute.first.substr (11).c_str (), NULL, 10)).toString ("Y-M-D H:N:S")
+                   + " "
+                   + attribute.second;
+  row ("Description", description);
+
+  row ("Status", capitalize (task.get ("status")));
+
+  // Known attributes, in the order Taskwarrior shows them.
+  static const std::vector <std::pair <std::string, std::string>> known {
+    {"project",   "Project"},
+    {"recur",     "Recurrence"},
+    {"parent",    "Parent task"},
+    {"depends",   "This task blocked by"},
+    {"entry",     "Entered"},
+    {"wait",      "Waiting until"},
+    {"scheduled", "Scheduled"},
+    {"start",     "Start"},
+    {"due",       "Due"},
+    {"end",       "End"},
+    {"until",     "Until"},
+    {"modified",  "Last modified"},
+    {"tags",      "Tags"},
+    {"uuid",      "UUID"},
+    {"urgency",   "Urgency"},
+  };
+
+  for (auto& attribute : known)
+  {
+    auto value = task.get (attribute.first);
+    if (value == "")
+      continue;
+
+    if (attribute.first == "tags" || attribute.first == "depends")
+      value = join (" ", split (value, ','));
+    else if (isDate (value))
+      value = formatDate (value, attribute.first == "entry"    ||
+                                 attribute.first == "start"    ||
+                                 attribute.first == "modified");
+
+    row (attribute.second, value);
+  }
+
+  // Everything else is a UDA, or an orphan.
+  for (auto& attribute : task.all ())
+  {
+    if (attribute.first == "id"          ||
+        attribute.first == "description" ||
+        attribute.first == "status"      ||
+        attribute.first == "mask"        ||
+        attribute.first == "imask"       ||
+        attribute.first.compare (0, 11, "annotation_") == 0)
+      continue;
+
+    bool isKnown = false;
+    for (auto& k : known)
+      if (k.first == attribute.first)
+        isKnown = true;
+
+    if (! isKnown)
+      row (capitalize (attribute.first),
+           isDate (attribute.second) ? formatDate (attribute.second) : attribute.second);
+  }
+
+  return "\n" + view.render () + "\n";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Renders a page of tasks for bulk review, one row each, numbered from 1,
+// with the action chosen for each.
+std::string renderPage (
+  const std::vector <const Task*>& tasks,
+  const std::vector <std::string>& actions,
+  unsigned int width,
+  bool color)
+{
+  Table view;
+  view.width (width ? width : 80);
+  view.add ("#", false);
+  view.add ("Action");
+  view.add ("ID", false);
+  view.add ("Project");
+  view.add ("Due");
+  view.add ("Tags");
+  view.add ("Description");
+  if (color)
+  {
+    view.colorHeader (Color ("underline"));
+    view.colorOdd (Color ("on gray2"));
+  }
+
+  for (unsigned int i = 0; i < tasks.size (); ++i)
+  {
+    auto& task = *tasks[i];
+    auto due = task.get ("due");
+
+    auto r = view.addRow ();
+    view.set (r, 0, (int) i + 1);
+    view.set (r, 1, actions[i]);
+    view.set (r, 2, task.get ("id") != "0" ? task.get ("id") : "");
+    view.set (r, 3, task.get ("project"));
+    view.set (r, 4, isDate (due) ? formatDate (due).substr (0, 10) : due);
+    view.set (r, 5, join (" ", split (task.get ("tags"), ',')));
+    view.set (r, 6, task.get ("description"));
+  }
+
+  return "\n" + view.render () + "\n";
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -26,6 +26,10 @@
 
 #include <cmake.h>
 #include <iostream>
+#include <fstream>
+#include <chrono>
+#include <thread>
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <cstring>
@@ -33,22 +37,30 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <shared.h>
+#include <format.h>
+#include <process.h>
+#include <Executor.h>
+#include <Config.h>
+#include <dispatch.h>
+#include <Watcher.h>
+#include <Segments.h>
+#include <Completion.h>
+#include <Script.h>
+#include <Trace.h>
 
 #ifdef HAVE_READLINE
 #include <readline/readline.h>
 #include <readline/history.h>
 #endif
 
-// TODO These conflict with tw commands. This needs to be resolved.
-//      Perhaps an escape, such as '-- help' could invoke local help, or using
-//      a 'task' prefix could disambiguate.
-
-// tasksh commands.
+// tasksh commands.  Some share names with Taskwarrior commands, which a 'task'
+// prefix reaches instead, as in 'task help'.
 int cmdHelp ();
 int cmdDiagnostics ();
+int cmdStats ();
 int cmdReview (const std::vector <std::string>&, bool);
-int cmdShell (const std::vector <std::string>&);
-std::string promptCompose ();
+int cmdShell (const std::string&);
+const std::string& promptCompose ();
 std::string findTaskwarrior ();
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -63,6 +75,15 @@ const std::string getResponse (const std::string& prompt)
 {
   std::string response {""};
 
+  // In batch mode, responses are the next lines of the script.
+  if (script.active ())
+  {
+    if (! script.next (response))
+      response = "<EOF>";
+
+    return response;
+  }
+
   // Display prompt, get input.
 #ifdef HAVE_READLINE
   char *line_read = readline (prompt.c_str ());
@@ -93,46 +114,170 @@ const std::string getResponse (const std::string& prompt)
   return response;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+static int runCommand (const std::string& command, bool autoClear)
+{
+  Span span ("dispatch", "shell", command);
+
+  int status = 0;
+  auto args = tokenize (command);
+  if (args.size () == 0)
+    return 0;
+
+  // Dispatch command.
+       if (closeEnough ("exit",        args[0], 3)) status = -1;
+  else if (closeEnough ("quit",        args[0], 3)) status = -1;
+  else if (closeEnough ("help",        args[0], 3)) status = cmdHelp ();
+  else if (closeEnough ("diagnostics", args[0], 3)) status = cmdDiagnostics ();
+  else if (args[0] == "stats")                      status = cmdStats ();
+  else if (closeEnough ("review",      args[0], 3)) status = cmdReview (args, autoClear);
+  else if (closeEnough ("exec",        args[0], 3) ||
+           args[0][0] == '!')                       status = cmdShell (command);
+  else if (needsShell ("task " + command))
+  {
+    // Pipes, redirection, substitution and the like are left to the shell,
+    // as they were when every command went through system ().
+    auto line = args[0] == "task" ? command : "task " + command;
+    std::cout << "[" << line << "]\n" << std::flush;
+    executor ().run ("/bin/sh", {"-c", line});
+  }
+  else if (args[0] == "task" && args.size () > 1)
+  {
+    // A 'task' prefix reaches Taskwarrior commands that share a name with a
+    // tasksh command, such as 'task stats'.
+    std::cout << "[" << command << "]\n";
+    cmdTask (std::vector <std::string> (args.begin () + 1, args.end ()));
+  }
+  else
+  {
+    std::cout << "[task " << command << "]\n";
+    cmdTask (args);
+
+    // Deliberately ignoreѕ taskwarrior exit status, otherwise empty filters
+    // cause the shell to terminate.
+  }
+
+  return status;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 static int commandLoop (bool autoClear)
 {
   // Compose the prompt.
-  auto prompt = promptCompose ();
+  std::string prompt;
+  {
+    Span span ("prompt", "shell");
+    prompt = promptCompose ();
+  }
 
   // Display prompt, get input.
-  auto command = getResponse (prompt);
+  std::string command;
+  {
+    Span span ("input", "shell");
+    command = getResponse (prompt);
+  }
 
   // Obey Taskwarrior's rc.tasksh.autoclear.
   if (autoClear)
     std::cout << "\033[2J\033[0;0H";
 
   int status = 0;
-  if (! isatty (fileno (stdin)) && command == "")
+  if (command == "<EOF>")
   {
     status = -1;
   }
   else if (command != "")
   {
-    auto args = split (command, ' ');
-
-    // Dispatch command.
-         if (args[0] == "<EOF>")                      status = -1;
-    else if (closeEnough ("exit",        args[0], 3)) status = -1;
-    else if (closeEnough ("quit",        args[0], 3)) status = -1;
-    else if (closeEnough ("help",        args[0], 3)) status = cmdHelp ();
-    else if (closeEnough ("diagnostics", args[0], 3)) status = cmdDiagnostics ();
-    else if (closeEnough ("review",      args[0], 3)) status = cmdReview (args, autoClear);
-    else if (closeEnough ("exec",        args[0], 3) ||
-             args[0][0] == '!')                       status = cmdShell (args);
-    else if (command != "")
-    {
-      command = "task " + command;
-      std::cout << "[" << command << "]\n";
-      system (command.c_str ());
+    status = runCommand (command, autoClear);
+  }
+
+  return status;
+}
 
-      // Deliberately ignoreѕ taskwarrior exit status, otherwise empty filters
-      // cause the shell to terminate.
+////////////////////////////////////////////////////////////////////////////////
+static bool isBuiltin (const std::vector <std::string>& args)
+{
+  return closeEnough ("exit",        args[0], 3) ||
+         closeEnough ("quit",        args[0], 3) ||
+         closeEnough ("help",        args[0], 3) ||
+         closeEnough ("diagnostics", args[0], 3) ||
+         args[0] == "stats"                      ||
+         closeEnough ("review",      args[0], 3) ||
+         closeEnough ("exec",        args[0], 3) ||
+         args[0][0] == '!';
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Output appears in the same order as if the commands had been run one at a
+// time, on stdout and stderr separately.  Each command's errors follow all of
+// its output, so the two streams combined may interleave differently.
+static void runReads (std::vector <std::string>& reads, unsigned int jobs)
+{
+  if (reads.size () == 1)
+  {
+    runCommand (reads[0], false);
+  }
+  else if (reads.size () > 1)
+  {
+    std::vector <std::vector <std::string>> lines;
+    for (auto& read : reads)
+      lines.push_back (tokenize (read));
+
+    cmdTasks (lines, jobs, [&reads] (size_t i, const std::string& output, const std::string& errors) {
+      std::cout << "[task " << reads[i] << "]\n" << output << std::flush;
+      std::cerr << errors << std::flush;
+    });
+  }
+
+  reads.clear ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Runs a whole script, with consecutive compatible mutations merged into one
+// Taskwarrior run.  There is no prompt, and the screen is never cleared.
+//
+// Consecutive read-only commands run concurrently, unless output is to a
+// terminal, which Taskwarrior would format differently.  Anything else waits
+// for them, and they wait for anything else.
+static int batchLoop ()
+{
+  auto start = std::chrono::steady_clock::now ();
+
+  unsigned int jobs = 1;
+  if (! isatty (fileno (stdout)))
+    jobs = config.getInteger ("tasksh.batch.jobs", std::max (std::thread::hardware_concurrency (), 1u));
+
+  int status = 0;
+  std::string command;
+  std::vector <std::string> reads;
+  while (status == 0 && script.take (command))
+  {
+    auto args = tokenize (command);
+    if (jobs > 1                          &&
+        args.size ()                      &&
+        args[0] != "task"                 &&
+        ! isBuiltin (args)                &&
+        ! needsShell ("task " + command)  &&
+        isReadOnly (args))
+    {
+      reads.push_back (command);
+      continue;
     }
+
+    runReads (reads, jobs);
+    status = runCommand (command, false);
+  }
+
+  runReads (reads, jobs);
+
+  if (config.getBoolean ("tasksh.batch.stats"))
+  {
+    double elapsed = std::chrono::duration <double> (std::chrono::steady_clock::now () - start).count ();
+    std::cerr << format ("{1} commands in {2} runs, {3} commands/sec.",
+                         script.lines (),
+                         script.runs (),
+                         (int) (script.lines () / (elapsed > 0 ? elapsed : 1)))
+              << "\n";
   }
 
   return status;
@@ -152,23 +297,69 @@ int main (int argc, const char** argv)
   {
     try
     {
+      // '-f <script>', '--trace=<file>' and '--executor=<backend>'.
+      std::string scriptFile;
+      std::string backend {"spawn"};
+      for (int i = 1; i < argc; ++i)
+      {
+        if (!strcmp (argv[i], "-f") && i + 1 < argc)
+          scriptFile = argv[++i];
+        else if (!strncmp (argv[i], "--trace=", 8))
+          trace.open (argv[i] + 8);
+        else if (!strncmp (argv[i], "--executor=", 11))
+          backend = argv[i] + 11;
+        else
+          throw format ("Unrecognized argument '{1}'.", argv[i]);
+      }
+
+      // Every program is run through the executor, including from background
+      // threads, so it is chosen before any of them start.
+      selectExecutor (backend);
+
       // Get the Taskwarrior rc.tasksh.autoclear Boolean setting.
-      bool autoClear = false;
-      std::string input;
-      std::string output;
-      execute ("task", {"_get", "rc.tasksh.autoclear"}, input, output);
-      output = lowerCase (output);
-      autoClear = (output == "true\n" ||
-                   output == "1\n"    ||
-                   output == "y\n"    ||
-                   output == "yes\n"  ||
-                   output == "on\n");
-
-      if (isatty (fileno (stdin)))
+      bool autoClear = config.getBoolean ("tasksh.autoclear");
+
+      // A script named by '-f', or non-interactive input, is run in batch
+      // mode.
+      if (scriptFile != "")
+      {
+        std::ifstream file (scriptFile);
+        if (! file.good ())
+          throw format ("Could not read '{1}'.", scriptFile);
+
+        script.load (file);
+      }
+      else if (! isatty (fileno (stdin)))
+      {
+        script.load (std::cin);
+      }
+
+      // Follow changes to the data files and configuration.
+      watcher.start ();
+
+      if (script.active ())
+      {
+        status = batchLoop ();
+      }
+      else
+      {
+        // Tab completion of commands, projects, tags and UUIDs.
+        completion.install ();
+
+        // Compute the prompt status segments in the background.
+        segments.start (split (config.get ("tasksh.prompt.segments"), ','),
+                        config.getInteger ("tasksh.prompt.budget", 250));
+
         welcome ();
 
-      while ((status = commandLoop (autoClear)) == 0)
-        ;
+        while ((status = commandLoop (autoClear)) == 0)
+          ;
+      }
+
+      segments.stop ();
+      deferredGC ();
+      watcher.stop ();
+      trace.close ();
     }
 
     catch (const std::string& error)
@@ -0,0 +1,954 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <process.h>
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <spawn.h>
+#include <signal.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#ifdef LINUX
+#include <sys/syscall.h>
+#endif
+#include <Accounting.h>
+#include <Trace.h>
+#include <Lexer.h>
+#include <format.h>
+#include <utf8.h>
+
+extern char** environ;
+
+////////////////////////////////////////////////////////////////////////////////
+// Quoting rules follow the shell closely enough for Taskwarrior arguments:
+//   - Whitespace (as defined by Lexer) separates arguments.
+//   - '...' is taken literally.
+//   - "..." is taken literally, except for \" and \\.
+//   - \x outside quotes is a literal x.
+//   - Quotes may appear mid-argument: description:"a b" -> description:a b
+std::vector <std::string> tokenize (const std::string& input)
+{
+  std::vector <std::string> args;
+  std::string word;
+  bool inWord = false;
+  int quote = 0;
+
+  std::string::size_type cursor = 0;
+  int c;
+  while ((c = utf8_next_char (input, cursor)))
+  {
+    if (quote)
+    {
+      if (c == quote)
+        quote = 0;
+      else if (c == '\\'                &&
+               quote == '"'             &&
+               (input[cursor] == '"' ||
+                input[cursor] == '\\'))
+        word += input[cursor++];
+      else
+        word += utf8_character (c);
+    }
+    else if (c == '\'' || c == '"')
+    {
+      quote = c;
+      inWord = true;
+    }
+    else if (c == '\\' && input[cursor])
+    {
+      word += utf8_character (utf8_next_char (input, cursor));
+      inWord = true;
+    }
+    else if (Lexer::isWhitespace (c))
+    {
+      if (inWord)
+      {
+        args.push_back (word);
+        word = "";
+        inWord = false;
+      }
+    }
+    else
+    {
+      word += utf8_character (c);
+      inWord = true;
+    }
+  }
+
+  // An unterminated quote is forgiven, and closed at the end of input.
+  if (inWord)
+    args.push_back (word);
+
+  return args;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Outside quotes, the shell gives meaning to these characters anywhere, to '~'
+// and '#' at the start of a word, and to '=' in the first word, which makes it
+// an assignment.  Within double quotes, '$' and '`' still substitute.
+// Parentheses are left alone, as the shell would reject them where they
+// appear in Taskwarrior filters.
+bool needsShell (const std::string& input)
+{
+  bool wordStart = true;
+  bool firstWord = true;
+  int quote = 0;
+
+  std::string::size_type cursor = 0;
+  int c;
+  while ((c = utf8_next_char (input, cursor)))
+  {
+    if (quote)
+    {
+      if (c == quote)
+        quote = 0;
+      else if (quote == '"' && (c == '$' || c == '`'))
+        return true;
+      else if (quote == '"' && c == '\\' && input[cursor])
+        utf8_next_char (input, cursor);
+    }
+    else if (c == '\'' || c == '"')
+    {
+      quote = c;
+      wordStart = false;
+    }
+    else if (c == '\\' && input[cursor])
+    {
+      utf8_next_char (input, cursor);
+      wordStart = false;
+    }
+    else if (c == '\n')
+    {
+      return true;
+    }
+    else if (Lexer::isWhitespace (c))
+    {
+      if (! wordStart)
+        firstWord = false;
+
+      wordStart = true;
+    }
+    else
+    {
+      if ((c < 128 && strchr ("|&;<>$`*?[", c)) ||
+          (wordStart && (c == '~' || c == '#')) ||
+          (firstWord && c == '='))
+        return true;
+
+      wordStart = false;
+    }
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static std::vector <char*> argvFor (
+  const std::string& executable,
+  const std::vector <std::string>& args)
+{
+  std::vector <char*> argv;
+  argv.push_back (const_cast <char*> (executable.c_str ()));
+  for (auto& arg : args)
+    argv.push_back (const_cast <char*> (arg.c_str ()));
+  argv.push_back (nullptr);
+  return argv;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Children are timed from just before they are spawned until they are reaped,
+// and accounted under a short name, such as 'task export'.
+class Timing
+{
+public:
+  Timing (const std::string& executable, const std::vector <std::string>& args)
+  : _start (std::chrono::steady_clock::now ())
+  {
+    auto slash = executable.rfind ('/');
+    name = slash == std::string::npos ? executable : executable.substr (slash + 1);
+
+    // The Taskwarrior command is the first word that is not an override, a
+    // filter term, an ID or a UUID.
+    if (name == "task")
+      for (auto& arg : args)
+        if (arg.compare (0, 3, "rc.") != 0 &&
+            arg.find_first_of (":=+-/()") == std::string::npos &&
+            arg.find_first_not_of ("0123456789,") != std::string::npos &&
+            ! (arg.length () == 8 && arg.find_first_not_of ("0123456789abcdef") == std::string::npos))
+        {
+          name += ' ' + arg;
+          break;
+        }
+  }
+
+  void spawned ()
+  {
+    _spawn = seconds ();
+  }
+
+  // Time taken by posix_spawnp.
+  double spawn () const
+  {
+    return _spawn;
+  }
+
+  // Time since the start.
+  double seconds () const
+  {
+    return std::chrono::duration <double> (std::chrono::steady_clock::now () - _start).count ();
+  }
+
+  Trace::Time start () const
+  {
+    return _start;
+  }
+
+  std::string name {};
+
+private:
+  std::chrono::steady_clock::time_point _start;
+  double                                _spawn {0.0};
+};
+
+////////////////////////////////////////////////////////////////////////////////
+static int exitStatus (int wstatus)
+{
+  if (WIFEXITED (wstatus))
+    return WEXITSTATUS (wstatus);
+
+  if (WIFSIGNALED (wstatus))
+    return 128 + WTERMSIG (wstatus);
+
+  return 127;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static void account (const Timing& timing, const struct rusage& usage)
+{
+  accounting.record (timing.name, timing.spawn (), timing.seconds (), usage);
+  trace.complete (timing.name, "process", timing.start (), std::chrono::steady_clock::now ());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static int waitFor (pid_t pid, const Timing& timing)
+{
+  int wstatus = 0;
+  struct rusage usage;
+  memset (&usage, 0, sizeof (usage));
+  while (wait4 (pid, &wstatus, 0, &usage) == -1 && errno == EINTR)
+    ;
+
+  account (timing, usage);
+  return exitStatus (wstatus);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A pidfd becomes readable when the child exits, so it can be polled along
+// with the pipes.  Linux 5.3 and later.
+static int pidfdOpen (pid_t pid)
+{
+#if defined (LINUX) && defined (SYS_pidfd_open)
+  return syscall (SYS_pidfd_open, pid, 0);
+#else
+  (void) pid;
+  return -1;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// While an event loop runs on the main thread, Ctrl-C is caught, and arrives
+// as a byte on a pipe, which the loop polls along with everything else.  The
+// previous handling is restored afterwards.  Static initialization happens on
+// the main thread.
+static const std::thread::id mainThread = std::this_thread::get_id ();
+static int interruptPipe[2] {-1, -1};
+
+static void onInterrupt (int)
+{
+  // Nothing can be done about a failed write here.
+  auto saved = errno;
+  auto written = write (interruptPipe[1], "", 1);
+  (void) written;
+  errno = saved;
+}
+
+class Interrupts
+{
+public:
+  Interrupts ()
+  {
+    // An ignored SIGINT stays ignored.
+    if (std::this_thread::get_id () != mainThread ||
+        sigaction (SIGINT, nullptr, &_old) == -1   ||
+        _old.sa_handler == SIG_IGN)
+      return;
+
+    if (interruptPipe[0] == -1)
+    {
+      if (pipe (interruptPipe) == -1)
+        return;
+
+      for (int fd : interruptPipe)
+      {
+        fcntl (fd, F_SETFD, FD_CLOEXEC);
+        fcntl (fd, F_SETFL, fcntl (fd, F_GETFL) | O_NONBLOCK);
+      }
+    }
+
+    clear ();
+
+    // Without SA_RESTART, so that a blocking wait is interrupted.
+    struct sigaction handler;
+    memset (&handler, 0, sizeof (handler));
+    handler.sa_handler = onInterrupt;
+    sigemptyset (&handler.sa_mask);
+    _installed = sigaction (SIGINT, &handler, nullptr) == 0;
+  }
+
+  ~Interrupts ()
+  {
+    if (_installed)
+      sigaction (SIGINT, &_old, nullptr);
+  }
+
+  int fd () const
+  {
+    return _installed ? interruptPipe[0] : -1;
+  }
+
+  void clear ()
+  {
+    char buffer[64];
+    while (read (interruptPipe[0], buffer, sizeof (buffer)) > 0)
+      ;
+  }
+
+private:
+  struct sigaction _old;
+  bool             _installed {false};
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Background threads never take Ctrl-C, so that it is left to the main
+// thread, and to any foreground child.
+void blockInterrupts ()
+{
+  sigset_t signals;
+  sigemptyset (&signals);
+  sigaddset (&signals, SIGINT);
+  sigaddset (&signals, SIGQUIT);
+  pthread_sigmask (SIG_BLOCK, &signals, nullptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Like system (), tasksh is not interrupted by SIGINT and SIGQUIT while a
+// foreground child runs, so that Ctrl-C terminates the child and not the
+// shell.  Unlike system (), they are blocked in the calling thread only, as
+// changing their disposition would affect every thread, and background
+// threads already block them.  Any that arrive meanwhile are discarded
+// afterwards.  The child starts with the original mask, and the default
+// dispositions.
+class Foreground
+{
+public:
+  Foreground ()
+  {
+    sigemptyset (&_signals);
+    sigaddset (&_signals, SIGINT);
+    sigaddset (&_signals, SIGQUIT);
+    pthread_sigmask (SIG_BLOCK, &_signals, &_oldMask);
+
+    posix_spawnattr_init (&attr);
+    posix_spawnattr_setsigdefault (&attr, &_signals);
+    posix_spawnattr_setsigmask (&attr, &_oldMask);
+    posix_spawnattr_setflags (&attr, POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK);
+  }
+
+  ~Foreground ()
+  {
+    posix_spawnattr_destroy (&attr);
+
+    sigset_t pending;
+    int signal;
+    while (sigpending (&pending) == 0             &&
+           (sigismember (&pending, SIGINT) == 1 ||
+            sigismember (&pending, SIGQUIT) == 1))
+      sigwait (&_signals, &signal);
+
+    pthread_sigmask (SIG_SETMASK, &_oldMask, nullptr);
+  }
+
+  posix_spawnattr_t attr;
+
+private:
+  sigset_t _signals;
+  sigset_t _oldMask;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// posix_spawnp avoids both the intermediate /bin/sh that system () uses, and
+// the page table copy of fork, as it is implemented with vfork/clone where
+// available.
+int spawn (
+  const std::string& executable,
+  const std::vector <std::string>& args)
+{
+  auto argv = argvFor (executable, args);
+  Foreground foreground;
+
+  pid_t pid;
+  Timing timing (executable, args);
+  int err = posix_spawnp (&pid, executable.c_str (), nullptr, &foreground.attr, argv.data (), environ);
+  timing.spawned ();
+  if (err)
+  {
+    std::cerr << format ("Could not run '{1}': {2}", executable, strerror (err)) << "\n";
+    return 127;
+  }
+
+  return waitFor (pid, timing);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The child sees a terminal of the given size, so it produces the same output,
+// including color, as it would when run directly.  Output processing is
+// disabled on the terminal, so the captured bytes are exactly those written.
+int spawnPty (
+  const std::string& executable,
+  const std::vector <std::string>& args,
+  unsigned short width,
+  unsigned short height,
+  std::string& output,
+  std::string::size_type limit /* = std::string::npos */)
+{
+  output = "";
+  auto argv = argvFor (executable, args);
+
+  int master = posix_openpt (O_RDWR | O_NOCTTY);
+  if (master == -1 ||
+      grantpt (master) == -1 ||
+      unlockpt (master) == -1)
+  {
+    if (master != -1)
+      close (master);
+
+    return spawn (executable, args);
+  }
+
+  int slave = open (ptsname (master), O_RDWR | O_NOCTTY);
+  if (slave == -1)
+  {
+    close (master);
+    return spawn (executable, args);
+  }
+
+  fcntl (master, F_SETFD, FD_CLOEXEC);
+  fcntl (slave,  F_SETFD, FD_CLOEXEC);
+
+  struct winsize size;
+  memset (&size, 0, sizeof (size));
+  size.ws_col = width;
+  size.ws_row = height;
+  ioctl (slave, TIOCSWINSZ, &size);
+
+  struct termios modes;
+  if (tcgetattr (slave, &modes) == 0)
+  {
+    modes.c_oflag &= ~OPOST;
+    tcsetattr (slave, TCSANOW, &modes);
+  }
+
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init (&actions);
+  posix_spawn_file_actions_addopen (&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+  posix_spawn_file_actions_adddup2 (&actions, slave, STDOUT_FILENO);
+  posix_spawn_file_actions_adddup2 (&actions, slave, STDERR_FILENO);
+
+  Foreground foreground;
+
+  pid_t pid;
+  Timing timing (executable, args);
+  int err = posix_spawnp (&pid, executable.c_str (), &actions, &foreground.attr, argv.data (), environ);
+  timing.spawned ();
+  posix_spawn_file_actions_destroy (&actions);
+  close (slave);
+
+  if (err)
+  {
+    close (master);
+    std::cerr << format ("Could not run '{1}': {2}", executable, strerror (err)) << "\n";
+    return 127;
+  }
+
+  // Once the child has exited and the output is drained, reading the master
+  // fails with EIO.
+  char buffer[16384];
+  ssize_t got;
+  while ((got = read (master, buffer, sizeof (buffer))) != 0)
+  {
+    if (got > 0)
+    {
+      if (output.size () <= limit)
+        output.append (buffer, got);
+
+      for (ssize_t written = 0, w; written < got; written += w)
+        if ((w = write (STDOUT_FILENO, buffer + written, got - written)) <= 0)
+          break;
+    }
+    else if (errno != EINTR)
+      break;
+  }
+
+  close (master);
+  return waitFor (pid, timing);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A child of an event loop.  Its pipes and pidfd are -1 when closed, or not
+// used.
+struct EventLoop::Child
+{
+  Child (const std::string& executable, const std::vector <std::string>& args)
+  : timing (executable, args)
+  {
+    memset (&usage, 0, sizeof (usage));
+  }
+
+  Timing                                timing;
+  Options                               options  {};
+  pid_t                                 pid      {0};
+  int                                   out      {-1};
+  int                                   err      {-1};
+  int                                   pidfd    {-1};
+  std::chrono::steady_clock::time_point deadline {};
+  bool                                  exited   {false};
+  bool                                  expired  {false};
+  int                                   status   {0};
+  struct rusage                         usage;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+EventLoop::EventLoop () = default;
+
+////////////////////////////////////////////////////////////////////////////////
+// Children not run to completion, because a callback threw, are killed.
+EventLoop::~EventLoop ()
+{
+  for (auto& child : _children)
+  {
+    for (int fd : {child->out, child->err, child->pidfd})
+      if (fd != -1)
+        close (fd);
+
+    if (! child->exited)
+    {
+      kill (-child->pid, SIGKILL);
+      while (! reap (*child, true))
+        ;
+    }
+
+    account (child->timing, child->usage);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Returns 0, or the error that prevented the child from starting.
+int EventLoop::start (
+  const std::string& executable,
+  const std::vector <std::string>& args,
+  const Options& options)
+{
+  std::unique_ptr <Child> child (new Child (executable, args));
+  child->options = options;
+  auto argv = argvFor (executable, args);
+
+  int out[2] {-1, -1};
+  int err[2] {-1, -1};
+  if ((options.output && pipe (out) == -1) ||
+      (options.errors && pipe (err) == -1))
+  {
+    auto error = errno;
+    for (int fd : {out[0], out[1], err[0], err[1]})
+      if (fd != -1)
+        close (fd);
+
+    return error;
+  }
+
+  for (int fd : {out[0], out[1], err[0], err[1]})
+    if (fd != -1)
+      fcntl (fd, F_SETFD, FD_CLOEXEC);
+
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init (&actions);
+  posix_spawn_file_actions_addopen (&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+
+  if (out[1] != -1)
+    posix_spawn_file_actions_adddup2 (&actions, out[1], STDOUT_FILENO);
+  else
+    posix_spawn_file_actions_addopen (&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+
+  if (err[1] != -1)
+    posix_spawn_file_actions_adddup2 (&actions, err[1], STDERR_FILENO);
+  else
+    posix_spawn_file_actions_addopen (&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+  posix_spawnattr_t attr;
+  posix_spawnattr_init (&attr);
+  posix_spawnattr_setpgroup (&attr, 0);
+  posix_spawnattr_setflags (&attr, POSIX_SPAWN_SETPGROUP);
+
+  int error = posix_spawnp (&child->pid, executable.c_str (), &actions, &attr, argv.data (), environ);
+  child->timing.spawned ();
+  posix_spawn_file_actions_destroy (&actions);
+  posix_spawnattr_destroy (&attr);
+
+  for (int fd : {out[1], err[1]})
+    if (fd != -1)
+      close (fd);
+
+  if (error)
+  {
+    for (int fd : {out[0], err[0]})
+      if (fd != -1)
+        close (fd);
+
+    return error;
+  }
+
+  child->out = out[0];
+  child->err = err[0];
+  for (int fd : {child->out, child->err})
+    if (fd != -1)
+      fcntl (fd, F_SETFL, fcntl (fd, F_GETFL) | O_NONBLOCK);
+
+  child->pidfd = pidfdOpen (child->pid);
+
+  if (options.timeout > 0)
+    child->deadline = std::chrono::steady_clock::now () + std::chrono::milliseconds (options.timeout);
+
+  _children.push_back (std::move (child));
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Returns once every child has exited, and all its output has been handled.
+// A child's 'done' callback may start another.
+void EventLoop::run ()
+{
+  Interrupts interrupts;
+  while (_children.size ())
+  {
+    std::vector <struct pollfd> fds;
+    int wait = -1;
+    bool deadlines = false;
+    auto now = std::chrono::steady_clock::now ();
+    for (auto& child : _children)
+    {
+      for (int fd : {child->out, child->err})
+        if (fd != -1)
+          fds.push_back ({fd, POLLIN, 0});
+
+      if (! child->exited && child->pidfd != -1)
+        fds.push_back ({child->pidfd, POLLIN, 0});
+
+      if (! child->exited && child->options.timeout > 0 && ! child->expired)
+      {
+        int remaining = std::chrono::duration_cast <std::chrono::milliseconds> (child->deadline - now).count () + 1;
+        remaining = std::max (remaining, 0);
+        wait = wait == -1 ? remaining : std::min (wait, remaining);
+        deadlines = true;
+      }
+
+      // Without a pidfd, a child with nothing more to read is checked on
+      // regularly.
+      if (! child->exited && child->pidfd == -1 && child->out == -1 && child->err == -1)
+        wait = wait == -1 ? 5 : std::min (wait, 5);
+    }
+
+    // Unless there is nothing else to do but wait for it.
+    if (fds.size () == 0 && _children.size () == 1 && ! deadlines)
+    {
+      reap (*_children[0], true);
+      wait = 0;
+    }
+
+    if (interrupts.fd () != -1)
+      fds.push_back ({interrupts.fd (), POLLIN, 0});
+
+    if (poll (fds.data (), fds.size (), wait) == -1 && errno != EINTR)
+      break;
+
+    auto ready = [&fds] (int fd)
+    {
+      for (auto& entry : fds)
+        if (entry.fd == fd)
+          return fd != -1 && entry.revents != 0;
+
+      return false;
+    };
+
+    if (ready (interrupts.fd ()))
+    {
+      interrupts.clear ();
+      interrupt ();
+    }
+
+    now = std::chrono::steady_clock::now ();
+    for (auto& child : _children)
+    {
+      if (ready (child->out))
+        read (child->out, child->options.output);
+
+      if (ready (child->err))
+        read (child->err, child->options.errors);
+
+      // The child leads its own process group, so anything it started is
+      // killed along with it, and no more output is awaited.
+      if (! child->exited && child->options.timeout > 0 && ! child->expired && now >= child->deadline)
+      {
+        kill (-child->pid, SIGKILL);
+        child->expired = true;
+        for (int* fd : {&child->out, &child->err})
+          if (*fd != -1)
+          {
+            close (*fd);
+            *fd = -1;
+          }
+      }
+
+      if (! child->exited &&
+          (ready (child->pidfd) ||
+           (child->pidfd == -1 && child->out == -1 && child->err == -1)))
+        reap (*child, false);
+    }
+
+    // A child is finished once it has exited, and its output is all read.
+    // Callbacks are made afterwards, as they may start more children.
+    std::vector <std::unique_ptr <Child>> finished;
+    for (auto child = _children.begin (); child != _children.end (); )
+    {
+      if ((*child)->exited && (*child)->out == -1 && (*child)->err == -1)
+      {
+        finished.push_back (std::move (*child));
+        child = _children.erase (child);
+      }
+      else
+        ++child;
+    }
+
+    for (auto& child : finished)
+    {
+      if (child->pidfd != -1)
+        close (child->pidfd);
+
+      account (child->timing, child->usage);
+      if (child->options.done)
+        child->options.done (child->expired ? 124 : child->status);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The pipe is non-blocking, so a spurious wakeup only costs a read.
+void EventLoop::read (
+  int& fd,
+  const std::function <void (const char*, size_t)>& handler)
+{
+  char buffer[16384];
+  auto got = ::read (fd, buffer, sizeof (buffer));
+  if (got > 0)
+  {
+    if (handler)
+      handler (buffer, got);
+  }
+  else if (got == 0 || (errno != EINTR && errno != EAGAIN))
+  {
+    close (fd);
+    fd = -1;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A blocking wait is given up if a signal arrives, such as Ctrl-C.
+bool EventLoop::reap (Child& child, bool block)
+{
+  int wstatus = 0;
+  auto pid = wait4 (child.pid, &wstatus, block ? 0 : WNOHANG, &child.usage);
+  if (pid == 0 || (pid == -1 && errno == EINTR))
+    return false;
+
+  child.exited = true;
+  child.status = pid == -1 ? 127 : exitStatus (wstatus);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Ctrl-C reaches tasksh alone, because the children have their own process
+// groups, so it is passed on to them.
+void EventLoop::interrupt ()
+{
+  for (auto& child : _children)
+    if (! child->exited)
+      kill (-child->pid, SIGINT);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int capture (
+  const std::string& executable,
+  const std::vector <std::string>& args,
+  std::string& output,
+  int timeout /* = 0 */)
+{
+  output = "";
+  int status = 127;
+
+  EventLoop::Options options;
+  options.output  = [&output] (const char* data, size_t size) { output.append (data, size); };
+  options.done    = [&status] (int result) { status = result; };
+  options.timeout = timeout;
+
+  EventLoop loop;
+  if (loop.start (executable, args, options) == 0)
+    loop.run ();
+
+  return status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Both pipes are drained together, so that a child filling one of them never
+// blocks.
+int collect (
+  const std::string& executable,
+  const std::vector <std::string>& args,
+  std::string& output,
+  std::string& errors)
+{
+  output = "";
+  errors = "";
+  int status = 127;
+
+  EventLoop::Options options;
+  options.output = [&output] (const char* data, size_t size) { output.append (data, size); };
+  options.errors = [&errors] (const char* data, size_t size) { errors.append (data, size); };
+  options.done   = [&status] (int result) { status = result; };
+
+  EventLoop loop;
+  auto error = loop.start (executable, args, options);
+  if (error)
+    errors = format ("Could not run '{1}': {2}", executable, strerror (error)) + "\n";
+  else
+    loop.run ();
+
+  return status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int stream (
+  const std::string& executable,
+  const std::vector <std::string>& args,
+  std::function <bool (const std::string&)> handler)
+{
+  int status = 127;
+
+  // The child is not killed when the reader loses interest, because it may be
+  // writing the data files.  Closing the pipe would risk SIGPIPE, so the rest
+  // is read, and dropped.
+  LineReader reader (handler);
+
+  EventLoop::Options options;
+  options.output = [&reader] (const char* data, size_t size)
+  {
+    if (reader.wanted ())
+      reader.feed (data, size);
+  };
+  options.done   = [&status] (int result) { status = result; };
+
+  EventLoop loop;
+  if (loop.start (executable, args, options) == 0)
+    loop.run ();
+
+  reader.finish ();
+  return status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+LineReader::LineReader (std::function <bool (const std::string&)> handler)
+: _handler (handler)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Lines are assembled in the one string, which keeps its capacity, so once it
+// has grown to fit the longest line there is no further allocation.  An
+// unterminated tail waits there for the next piece.
+void LineReader::feed (const char* data, size_t size)
+{
+  const char* end = data + size;
+  while (_wanted && data < end)
+  {
+    auto newline = (const char*) memchr (data, '\n', end - data);
+    if (! newline)
+    {
+      _line.append (data, end - data);
+      return;
+    }
+
+    _line.append (data, newline - data);
+    _wanted = _handler (_line);
+    _line.clear ();
+    data = newline + 1;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void LineReader::finish ()
+{
+  if (_wanted && _line != "")
+    _wanted = _handler (_line);
+
+  _line.clear ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool LineReader::wanted () const
+{
+  return _wanted;
+}
+
+////////////////////////////////////////////////////////////////////////////////
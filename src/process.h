@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_PROCESS
+#define INCLUDED_PROCESS
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <memory>
+
+// Split a command line into arguments, observing quotes and escapes the way
+// the shell would, so that the result can be passed directly to execvp.
+std::vector <std::string> tokenize (const std::string&);
+
+// True if the command line uses shell syntax that tokenize does not interpret,
+// such as a pipe, redirection, substitution or a glob, so that it must be run
+// with /bin/sh -c to mean what it says.
+bool needsShell (const std::string&);
+
+// Blocks SIGINT and SIGQUIT in the calling thread.  Every background thread
+// calls this first, so that Ctrl-C only ever reaches the main thread, which
+// may be running a foreground child, or waiting for one.
+void blockInterrupts ();
+
+// Run a program directly (no /bin/sh) with inherited stdin/stdout/stderr, and
+// wait for it.  Returns the exit status.
+int spawn (const std::string&, const std::vector <std::string>&);
+
+// Like spawn, but the child's stdout and stderr are a pseudo-terminal of the
+// given width and height.  Output is copied to stdout as it arrives, and also
+// captured, up to the given limit, beyond which capturing stops.
+int spawnPty (const std::string&, const std::vector <std::string>&, unsigned short, unsigned short, std::string&, std::string::size_type limit = std::string::npos);
+
+// Run a program directly and capture its standard output.  The child has no
+// terminal input, discards stderr, and runs in its own process group, so it
+// is safe to use from background threads.  Returns the exit status.
+//
+// If a timeout in milliseconds is given and the child has not finished by
+// then, it is killed, and 124 is returned, as timeout(1) does.
+int capture (const std::string&, const std::vector <std::string>&, std::string&, int timeout = 0);
+
+// Like capture, but standard error is also captured, separately.
+int collect (const std::string&, const std::vector <std::string>&, std::string&, std::string&);
+
+// Like capture, but each line of output, without its newline, is handed to
+// the callback as soon as it arrives, instead of being accumulated.  Once the
+// callback returns false, the rest of the output is still read, so that the
+// child never blocks on a full pipe, but dropped, and the child is left to
+// finish.
+int stream (const std::string&, const std::vector <std::string>&, std::function <bool (const std::string&)>);
+
+// Runs any number of children from the one thread, without a thread each.
+// Their output is read from non-blocking pipes and handed to callbacks as it
+// arrives, and they are reaped as they exit, via pidfd where the system has
+// it.  Each child leads its own process group, so that anything it starts is
+// also killed if it times out.  When run on the main thread, Ctrl-C is passed
+// on to the children, instead of ending tasksh, and they typically exit with
+// 130.
+class EventLoop
+{
+public:
+  struct Options
+  {
+    std::function <void (const char*, size_t)> output  {};   // Discarded if empty
+    std::function <void (const char*, size_t)> errors  {};   // Discarded if empty
+    std::function <void (int)>                 done    {};
+    int                                        timeout {0};  // Milliseconds
+  };
+
+  EventLoop ();
+  ~EventLoop ();
+
+  int start (const std::string&, const std::vector <std::string>&, const Options&);
+  void run ();
+
+private:
+  struct Child;
+
+  void read (int&, const std::function <void (const char*, size_t)>&);
+  bool reap (Child&, bool);
+  void interrupt ();
+
+  std::vector <std::unique_ptr <Child>> _children {};
+};
+
+// Splits output into lines for stream, and for anything else that has output
+// in pieces.  The string passed to the callback is reused for every line.
+class LineReader
+{
+public:
+  LineReader (std::function <bool (const std::string&)>);
+
+  void feed (const char*, size_t);
+  void finish ();
+  bool wanted () const;
+
+private:
+  std::function <bool (const std::string&)> _handler;
+  std::string                               _line    {};
+  bool                                      _wanted  {true};
+};
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
@@ -28,6 +28,9 @@
 #include <vector>
 #include <string>
 #include <Color.h>
+#include <Config.h>
+#include <Segments.h>
+#include <Watcher.h>
 
 static std::vector <std::string> contextColors = {
   "bold white on red",
@@ -41,12 +44,38 @@ static std::vector <std::string> contextColors = {
 
 static std::vector <std::string> contexts;
 
-std::string composeContexts (bool pretty = false);
+// The plain and pretty (colored, with readline escapes) forms of the context
+// tokens are maintained as contexts are added and removed, along with their
+// lengths before each addition, so that removal is a truncation.
+static std::string plainContexts;
+static std::string prettyContexts;
+static std::vector <std::pair <std::string::size_type, std::string::size_type>> marks;
+
+// Set whenever the contexts change, so the prompt is composed again.
+static bool changed = true;
+
+const std::string& composeContexts (bool pretty = false);
+
+////////////////////////////////////////////////////////////////////////////////
+// Color specs are parsed once, on first use.
+static const Color& contextColor (unsigned int index)
+{
+  static std::vector <Color> colors;
+  if (colors.size () == 0)
+    for (auto& spec : contextColors)
+      colors.push_back (Color (spec));
+
+  return colors[index % colors.size ()];
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 int promptClear ()
 {
   contexts.clear ();
+  marks.clear ();
+  plainContexts = "";
+  prettyContexts = "";
+  changed = true;
   return 0;
 }
 
@@ -54,7 +83,13 @@ int promptClear ()
 int promptRemove ()
 {
   if (contexts.size ())
+  {
     contexts.pop_back ();
+    plainContexts.resize (marks.back ().first);
+    prettyContexts.resize (marks.back ().second);
+    marks.pop_back ();
+    changed = true;
+  }
 
   return 0;
 }
@@ -62,42 +97,58 @@ int promptRemove ()
 ////////////////////////////////////////////////////////////////////////////////
 int promptAdd (const std::string& context)
 {
+  marks.push_back ({plainContexts.length (), prettyContexts.length ()});
+
+  plainContexts += context;
+  plainContexts += ' ';
+
+  prettyContexts += '\001';
+  prettyContexts += contextColor (contexts.size ()).colorize ("\002 " + context + " \001");
+  prettyContexts += "\002 ";
+
   contexts.push_back (context);
+  changed = true;
   return 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-std::string composeContexts (bool pretty /* = false */)
+// Both forms end with a space, unless there are no contexts.
+const std::string& composeContexts (bool pretty /* = false */)
 {
-  std::string combined;
-  for (unsigned int i = 0; i < contexts.size (); i++)
-    if (pretty)
-      combined += (combined != "" ? " " : "")
-                + std::string ("\001")
-                + Color::colorize ("\002 " + contexts[i] + " \001", contextColors[i % contextColors.size ()])
-                + "\002";
-    else
-      combined += (combined != "" ? " " : "") + contexts[i];
-
-  if (combined != "")
-    combined += ' ';
-
-  return combined;
+  return pretty ? prettyContexts : plainContexts;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-std::string promptCompose ()
+const std::string& promptCompose ()
 {
-  // TODO The prompt may be composed of different elements:
-  // TODO - The configurable text
-  // TODO - The accumulated context, as colored tokens.
-  // TODO - sync status
-  // TODO - time
-  auto decoration = composeContexts (true);
+  // The prompt is composed of:
+  // - The accumulated context, as colored tokens.
+  // - The status segments, such as sync status and time, as of the last data
+  //   change.
+  if (segments.running ())
+    segments.update (watcher.dataGeneration (),
+                     watcher.configGeneration (),
+                     config.dataLocation ());
+
+  static std::string prompt;
+  static std::string shown;
+
+  auto status = segments.compose ();
+  if (! changed && status == shown)
+    return prompt;
+
+  changed = false;
+  shown = status;
+  if (status.length ())
+    status = "[" + status + "]";
+
+  auto& decoration = composeContexts (true);
   if (decoration.length ())
-    return "task " + decoration + "> ";
+    prompt = "task " + decoration + (status.length () ? status + " " : "") + "> ";
+  else
+    prompt = "tasksh" + (status.length () ? " " + status : "") + "> ";
 
-  return "tasksh> ";
+  return prompt;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
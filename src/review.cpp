@@ -29,7 +29,11 @@
 #include <sstream>
 #include <vector>
 #include <string>
+#include <map>
+#include <unordered_map>
 #include <algorithm>
+#include <chrono>
+#include <limits>
 #include <stdlib.h>
 
 #ifdef HAVE_READLINE
@@ -45,11 +49,50 @@
 #endif
 
 #include <Color.h>
-#include <Lexer.h>
 #include <shared.h>
 #include <format.h>
+#include <process.h>
+#include <Executor.h>
+#include <Task.h>
+#include <Uuid.h>
+#include <ReviewQueue.h>
+#include <WriteQueue.h>
+#include <Prefetcher.h>
+#include <Config.h>
+#include <Watcher.h>
+#include <Trace.h>
 
 std::string getResponse (const std::string&);
+std::string renderInformation (const Task&, unsigned int, bool);
+std::string renderPage (const std::vector <const Task*>&, const std::vector <std::string>&, unsigned int, bool);
+
+// Tasks are exported by UUID, in chunks of this size, to keep the command
+// line and the filter reasonable.
+static const unsigned int exportChunk = 100;
+
+// Tasks to review are fetched from the '_reviewed' report in pages of this
+// size.
+static const unsigned int reviewPage = 100;
+
+// A review session is resumed from where the last one stopped, if that was
+// no more than this many seconds ago, unless overridden by
+// rc.tasksh.review.resume.
+static const int defaultResume = 86400;
+
+// Review actions are written in batches of this size, unless overridden by
+// rc.tasksh.review.batch.
+static const unsigned int defaultBatch = 10;
+
+// The 'information' output for this many upcoming tasks is rendered in the
+// background, unless overridden by rc.tasksh.review.prefetch, using at most
+// maxPrefetchers threads.  Only with rc.tasksh.review.information=task, as
+// native rendering uses the exported data.
+static const unsigned int defaultPrefetch = 3;
+static const unsigned int maxPrefetchers  = 2;
+
+// Bulk review shows this many tasks per page, unless overridden by
+// rc.tasksh.review.page.
+static const unsigned int defaultPage = 20;
 
 ////////////////////////////////////////////////////////////////////////////////
 static unsigned int getWidth ()
@@ -69,18 +112,70 @@ static unsigned int getWidth ()
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-static void editTask (const std::string& uuid)
+// Tells the review whether the data changed since it last looked, other than
+// by its own changes, which it refreshes itself.  The generation is cheap to
+// compare, and the signature tells whether a new generation is only the
+// review's own change arriving late.  Writes from the queue are followed
+// from one signature to the next, and are the review's own as long as the
+// chain is unbroken.
+class DataChanges
 {
-  std::string command = "task rc.confirmation:no rc.verbose:nothing " + uuid + " edit";
-  system (command.c_str ());
+public:
+  DataChanges (WriteQueue& writes)
+  : _writes (writes)
+  , _generation (watcher.dataGeneration ())
+  , _signature (watcher.dataSignature ())
+  {
+  }
+
+  // The review changed the data, and refreshed what it changed.
+  void ours ()
+  {
+    _generation = watcher.dataGeneration ();
+    _signature  = watcher.dataSignature ();
+  }
+
+  // The tasks the queue wrote meanwhile are added to 'written'.
+  bool changed (std::vector <Uuid>& written)
+  {
+    for (auto& run : _writes.written ())
+    {
+      if (run.before == _signature)
+        _signature = run.after;
+
+      written.insert (written.end (), run.uuids.begin (), run.uuids.end ());
+    }
+
+    auto generation = watcher.dataGeneration ();
+    if (generation == _generation)
+      return false;
+
+    _generation = generation;
+    auto signature = watcher.dataSignature ();
+    if (signature == _signature)
+      return false;
+
+    _signature = signature;
+    return true;
+  }
+
+private:
+  WriteQueue&   _writes;
+  unsigned long _generation;
+  std::string   _signature;
+};
 
-  command = "task rc.confirmation:no rc.verbose:nothing " + uuid + " modify reviewed:now";
-  system (command.c_str ());
+////////////////////////////////////////////////////////////////////////////////
+static void editTask (const Uuid& uuid, WriteQueue& writes)
+{
+  writes.wait (uuid);
+  executor ().run ("task", {"rc.confirmation:no", "rc.verbose:nothing", uuid.str (), "edit"});
+  writes.add (uuid, {"modify", "reviewed:now"});
   std::cout << "Modified.\n\n\n\n";
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-static void modifyTask (const std::string& uuid)
+static void modifyTask (const Uuid& uuid, WriteQueue& writes)
 {
   Color text ("color15 on gray6");
   std::string modifications;
@@ -90,33 +185,34 @@ static void modifyTask (const std::string& uuid)
   }
   while (modifications == "");
 
-  std::string command = "task rc.confirmation:no rc.verbose:nothing " + uuid + " modify " + modifications;
-  system (command.c_str ());
+  std::vector <std::string> args {"rc.confirmation:no", "rc.verbose:nothing", uuid.str (), "modify"};
+  for (auto& arg : tokenize (modifications))
+    args.push_back (arg);
+
+  writes.wait (uuid);
+  executor ().run ("task", args);
 
   std::cout << "Modified.\n\n\n\n";
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-static void reviewTask (const std::string& uuid)
+static void reviewTask (const Uuid& uuid, WriteQueue& writes)
 {
-  std::string command = "task rc.confirmation:no rc.verbose:nothing " + uuid + " modify reviewed:now";
-  system (command.c_str ());
+  writes.add (uuid, {"modify", "reviewed:now"});
   std::cout << "Marked as reviewed.\n\n\n\n";
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-static void completeTask (const std::string& uuid)
+static void completeTask (const Uuid& uuid, WriteQueue& writes)
 {
-  std::string command = "task rc.confirmation:no rc.verbose:nothing " + uuid + " done";
-  system (command.c_str ());
+  writes.add (uuid, {"done"});
   std::cout << "Completed.\n\n\n\n";
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-static void deleteTask (const std::string& uuid)
+static void deleteTask (const Uuid& uuid, WriteQueue& writes)
 {
-  std::string command = "task rc.confirmation:no rc.verbose:nothing " + uuid + " delete";
-  system (command.c_str ());
+  writes.add (uuid, {"delete"});
   std::cout << "Deleted.\n\n\n\n";
 }
 
@@ -153,6 +249,7 @@ static const std::string reviewStart (
 static const std::string banner (
   unsigned int current,
   unsigned int total,
+  unsigned int pending,
   unsigned int width,
   const std::string& message)
 {
@@ -160,8 +257,14 @@ static const std::string banner (
   progress << " ["
            << current
            << " of "
-           << total
-           << "] ";
+           << total;
+
+  if (pending)
+    progress << ", "
+             << pending
+             << " unwritten";
+
+  progress << "] ";
 
   Color progressColor ("color15 on color9");
   Color descColor     ("color15 on gray6");
@@ -185,68 +288,220 @@ static const std::string menu ()
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-static void reviewLoop (const std::vector <std::string>& uuids, unsigned int limit, bool autoClear)
+static const std::string bulkMenu ()
+{
+  return Color ("color15 on gray6").colorize (" (Enter) Commit page, (r)eview, (s)kip, (c)omplete, (d)elete <rows>, (m)odify <rows> <args>, (q)uit ") + " ";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Failed writes are reported at the next prompt after they happen.
+static void reportFailures (WriteQueue& writes)
+{
+  for (auto& failure : writes.failures ())
+    std::cerr << failure << "\n";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Waits for every write, so that the summary and checkpoint are accurate.
+static void drainWrites (WriteQueue& writes)
+{
+  writes.flush ();
+  if (writes.pending ())
+    std::cout << format ("Writing {1} changes...", writes.pending ()) << "\n";
+
+  writes.drain ();
+  reportFailures (writes);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static void exportTasks (
+  const std::vector <std::string>& filter,
+  std::unordered_map <Uuid, Task>& tasks)
+{
+  // Exporting does not need garbage collection, which would only rewrite the
+  // data files, and change the data generation.
+  std::vector <std::string> args {"rc.verbose=nothing", "rc.json.array=off", "rc.gc=off"};
+  args.insert (args.end (), filter.begin (), filter.end ());
+  args.push_back ("export");
+
+  // Tasks are parsed line by line as they arrive, so the whole export is
+  // never held at once.
+  Task task;
+  Uuid uuid;
+  executor ().stream ("task", args, [&tasks, &task, &uuid] (const std::string& line)
+  {
+    if (parseExportLine (line, task) &&
+        Uuid::parse (task.get ("uuid"), uuid))
+      tasks[uuid] = task;
+
+    return true;
+  });
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static void exportTasks (
+  std::vector <Uuid>::const_iterator first,
+  std::vector <Uuid>::const_iterator last,
+  std::unordered_map <Uuid, Task>& tasks)
 {
+  std::vector <std::string> filter;
+  for (auto uuid = first; uuid != last; ++uuid)
+    filter.push_back (uuid->str ());
+
+  exportTasks (filter, tasks);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Refreshes those tasks the review wrote that are still to be shown.
+static void exportWritten (
+  const std::vector <Uuid>& written,
+  std::vector <Uuid>::const_iterator first,
+  std::vector <Uuid>::const_iterator last,
+  std::unordered_map <Uuid, Task>& tasks)
+{
+  std::vector <std::string> filter;
+  for (auto& uuid : written)
+    if (std::find (first, last, uuid) != last)
+      filter.push_back (uuid.str ());
+
+  if (filter.size ())
+    exportTasks (filter, tasks);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Load the metadata for a page of the review set, so that the review loop
+// does not need to run Taskwarrior just to display the banner.
+static void loadTasks (
+  const std::vector <Uuid>& uuids,
+  std::unordered_map <Uuid, Task>& tasks)
+{
+  for (unsigned int i = 0; i < uuids.size (); i += exportChunk)
+    exportTasks (uuids.begin () + i,
+                 uuids.begin () + std::min ((unsigned int) uuids.size (), i + exportChunk),
+                 tasks);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static unsigned int reviewLoop (
+  ReviewQueue& queue,
+  WriteQueue& writes,
+  unsigned int limit,
+  unsigned int batch,
+  unsigned int prefetch,
+  bool native,
+  bool autoClear)
+{
+  // Review decisions are buffered, and written in batches, in the background.
+  writes.batchSize (batch);
+
   auto width = getWidth ();
   unsigned int reviewed = 0;
 
-  // If a limit was specified ('review 10'), then it should override the data
-  // set size, if it is smaller.
-  unsigned int total = uuids.size ();
-  if (limit)
-    total = std::min (total, limit);
-
-  if (total == 0)
+  // The queue already allows for a limit ('review 10').
+  if (queue.total () == 0)
   {
     std::cout << reviewNothing ();
-    return;
+    return 0;
   }
 
   std::cout << reviewStart (width);
 
+  // The table is refreshed when something else changes the data.  A task the
+  // review itself changes is refreshed alone.
+  DataChanges changes (writes);
+
+  // Native rendering runs nothing per task, so there is nothing to prefetch.
+  if (native)
+    prefetch = 0;
+
+  // While one task is being reviewed, the next few are rendered.
+  Prefetcher prefetcher (std::min (prefetch, maxPrefetchers),
+                         width,
+                         isatty (STDOUT_FILENO));
+
   unsigned int current = 0;
-  while (current < total &&
-         (limit == 0 || reviewed < limit))
+  Uuid uuid;
+  while ((limit == 0 || reviewed < limit) &&
+         queue.get (current, uuid))
   {
-    // Run 'info' report for task.
-    auto uuid = uuids[current];
-
-    // Display banner for this task.
-    std::string dummy;
-    std::string description;
-    execute ("task",
-             {"_get", uuid + ".description"},
-             dummy,
-             description);
+    auto shown = current;
+    auto& uuids = queue.uuids ();
 
     std::string response;
     bool repeat;
     do
     {
       repeat = false;
-      std::cout << banner (current + 1, total, width, Lexer::trimRight (description, "\n"));
 
-      // Use 'system' to run the command and show the output.
-      std::string command = "task " + uuid + " information";
-      system (command.c_str ());
+      // Refresh this and the following tasks, if anything changed.
+      std::vector <Uuid> written;
+      auto first = uuids.begin () + current;
+      auto last  = uuids.begin () + std::min ((unsigned int) uuids.size (), current + exportChunk);
+      if (changes.changed (written))
+      {
+        Span span ("review.refresh", "review");
+        exportTasks (first, last, queue.tasks ());
+        prefetcher.clear ();
+      }
+      else
+        exportWritten (written, first, last, queue.tasks ());
+
+      // Run 'info' report for the following tasks.  Only tasks already
+      // fetched are rendered ahead.
+      for (unsigned int ahead = current + 1; ahead <= current + prefetch && ahead < uuids.size (); ++ahead)
+        prefetcher.request (uuids[ahead]);
+
+      // Display banner for this task.
+      reportFailures (writes);
+      auto& task = queue.tasks ()[uuid];
+      {
+        Span span ("review.banner", "review", uuid.str ());
+        std::cout << banner (current + 1, queue.total (), writes.pending (), width, task.get ("description"));
+      }
+
+      // Render the details from the exported data, or show the prefetched
+      // output, or run the command directly.
+      {
+        Span span ("review.information", "review", uuid.str ());
+        if (native)
+          std::cout << renderInformation (task, width, isatty (STDOUT_FILENO)) << std::flush;
+        else if (prefetch)
+          std::cout << prefetcher.get (uuid) << std::flush;
+        else
+          executor ().run ("task", {uuid.str (), "information"});
+      }
 
       // Display prompt, get input.
-      response = getResponse (menu ());
+      {
+        Span span ("review.input", "review");
+        response = getResponse (menu ());
+      }
 
-           if (response == "e") { editTask (uuid);                                   }
-      else if (response == "m") { modifyTask (uuid);          repeat = true;         }
-      else if (response == "s") { std::cout << "Skipped\n\n"; ++current;             }
-      else if (response == "c") { completeTask (uuid);        ++current; ++reviewed; }
-      else if (response == "d") { deleteTask (uuid);          ++current; ++reviewed; }
-      else if (response == "")  { reviewTask (uuid);          ++current; ++reviewed; }
-      else if (response == "r") { reviewTask (uuid);          ++current; ++reviewed; }
-      else if (response == "q") { break;                                             }
+           if (response == "e")     { editTask (uuid, writes);                                 }
+      else if (response == "m")     { modifyTask (uuid, writes);      repeat = true;         }
+      else if (response == "s")     { std::cout << "Skipped\n\n";     ++current;             }
+      else if (response == "c")     { completeTask (uuid, writes);    ++current; ++reviewed; }
+      else if (response == "d")     { deleteTask (uuid, writes);      ++current; ++reviewed; }
+      else if (response == "")      { reviewTask (uuid, writes);      ++current; ++reviewed; }
+      else if (response == "r")     { reviewTask (uuid, writes);      ++current; ++reviewed; }
+      else if (response == "q")     { break;                                                 }
+      else if (response == "<EOF>") { response = "q"; break;                                 }
 
       else
       {
         std::cout << format ("Command '{1}' is not recognized.", response) << "\n";
       }
 
+      // The task changed, so any rendered output is stale.
+      if (response == "e" || response == "m")
+      {
+        exportTasks ({uuid.str ()}, queue.tasks ());
+        changes.ours ();
+
+        if (! native)
+          prefetcher.invalidate (uuid);
+      }
+
       // Note that just hitting <Enter> yields an empty command, which does
       // nothing but advance to the next task.
 
@@ -257,63 +512,291 @@ static void reviewLoop (const std::vector <std::string>& uuids, unsigned int lim
 
     if (response == "q")
       break;
+
+    // Rendered output is not needed once the task has been passed.
+    if (current != shown)
+      prefetcher.invalidate (uuid);
   }
 
+  // Write everything still buffered before summarizing.
+  drainWrites (writes);
+
   std::cout << "\n"
-            << format ("End of review. {1} out of {2} tasks reviewed.", reviewed, total)
+            << format ("End of review. {1} out of {2} tasks reviewed.", reviewed, queue.total ())
             << "\n\n";
+
+  return current;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Parses row numbers, and ranges such as '3-5', from the start of 'words',
+// leaving whatever follows.  Rows are numbered from 1, and returned from 0.
+static bool parseRows (
+  std::vector <std::string>& words,
+  unsigned int count,
+  std::vector <unsigned int>& rows)
+{
+  rows.clear ();
+  while (words.size ())
+  {
+    auto& word = words[0];
+    if (word == "" || word.find_first_not_of ("0123456789-") != std::string::npos)
+      break;
+
+    auto dash = word.find ('-');
+    auto from = strtoul (word.c_str (), NULL, 10);
+    auto to   = dash == std::string::npos ? from : strtoul (word.c_str () + dash + 1, NULL, 10);
+    if (from < 1 || to < from || to > count)
+      return false;
+
+    for (auto row = from; row <= to; ++row)
+      rows.push_back (row - 1);
+
+    words.erase (words.begin ());
+  }
+
+  return rows.size () > 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Shows a page of tasks at a time, from one export, as a table.  Every task is
+// to be marked as reviewed unless another action is chosen for its row, and
+// the whole page is written at once when it is committed.  Only tasks whose
+// writes succeed are counted as reviewed, though pages committed and still
+// being written count towards the limit.
+static unsigned int bulkLoop (
+  ReviewQueue& queue,
+  WriteQueue& writes,
+  unsigned int limit,
+  unsigned int pageSize,
+  bool autoClear)
+{
+  // Each page is written in one go, by the fewest Taskwarrior commands, in the
+  // background, apart from modified rows, which are written before the next
+  // page is shown.
+  writes.batchSize (std::numeric_limits <unsigned int>::max ());
+
+  auto width = getWidth ();
+  auto color = isatty (STDOUT_FILENO);
+  unsigned int committed = 0;
+  unsigned int reviewed = 0;
+
+  // Earlier writes, such as those recovered from the journal, are not counted.
+  writes.succeeded ();
+
+  if (queue.total () == 0)
+  {
+    std::cout << reviewNothing ();
+    return 0;
+  }
+
+  DataChanges changes (writes);
+  unsigned int current = 0;
+  bool quit = false;
+  while (! quit &&
+         (limit == 0 || committed < limit))
+  {
+    std::vector <Uuid> page;
+    Uuid next;
+    while (page.size () < std::max (pageSize, 1u) &&
+           queue.get (current + page.size (), next))
+      page.push_back (next);
+
+    if (page.size () == 0)
+      break;
+
+    // Refresh the page, if anything changed.
+    std::vector <Uuid> written;
+    if (changes.changed (written))
+    {
+      Span span ("review.refresh", "review");
+      exportTasks (page.begin (), page.end (), queue.tasks ());
+    }
+    else
+      exportWritten (written, page.begin (), page.end (), queue.tasks ());
+
+    std::vector <const Task*> tasks;
+    for (auto& uuid : page)
+      tasks.push_back (&queue.tasks ()[uuid]);
+
+    std::vector <std::string> actions (page.size (), "review");
+    std::vector <std::vector <std::string>> modifications (page.size ());
+    while (true)
+    {
+      reportFailures (writes);
+      {
+        Span span ("review.page", "review");
+        std::cout << banner (current + 1, queue.total (), writes.pending (), width,
+                             format ("Tasks {1} to {2}", current + 1, current + page.size ()))
+                  << renderPage (tasks, actions, width, color);
+      }
+
+      std::string response;
+      {
+        Span span ("review.input", "review");
+        response = getResponse (bulkMenu ());
+      }
+
+      if (autoClear)
+        std::cout << "\033[2J\033[0;0H";
+
+      if (response == "q" || response == "<EOF>")
+      {
+        quit = true;
+        break;
+      }
+
+      auto words = tokenize (response);
+      if (words.size () == 0)
+        break;
+
+      auto command = words[0];
+      words.erase (words.begin ());
+
+      std::vector <unsigned int> rows;
+      static const std::map <std::string, std::string> names {
+        {"r", "review"}, {"s", "skip"}, {"c", "complete"}, {"d", "delete"}, {"m", "modify"}};
+
+      auto name = names.find (command);
+      if (name == names.end () ||
+          ! parseRows (words, page.size (), rows) ||
+          (command == "m") != (words.size () > 0))
+      {
+        std::cout << format ("Command '{1}' is not recognized.", response) << "\n";
+        continue;
+      }
+
+      for (auto row : rows)
+      {
+        actions[row] = name->second;
+        modifications[row] = words;
+      }
+    }
+
+    // Nothing on a page that was quit is written.
+    if (quit)
+      break;
+
+    for (unsigned int i = 0; i < page.size (); ++i)
+    {
+      if (actions[i] == "skip")
+        continue;
+
+      if (actions[i] == "complete")
+        writes.add (page[i], {"done"});
+      else if (actions[i] == "delete")
+        writes.add (page[i], {"delete"});
+      else
+      {
+        std::vector <std::string> action {"modify"};
+        action.insert (action.end (), modifications[i].begin (), modifications[i].end ());
+        action.push_back ("reviewed:now");
+        writes.add (page[i], action);
+      }
+
+      ++committed;
+    }
+
+    writes.flush ();
+    current += page.size ();
+
+    reviewed += writes.succeeded ();
+    std::cout << format ("Page committed. {1} tasks reviewed so far, and {2} being written.", reviewed, writes.pending ()) << "\n\n";
+  }
+
+  drainWrites (writes);
+  reviewed += writes.succeeded ();
+
+  std::cout << "\n"
+            << format ("End of review. {1} out of {2} tasks reviewed.", reviewed, queue.total ())
+            << "\n\n";
+
+  return current;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 int cmdReview (const std::vector <std::string>& args, bool autoClear)
 {
-  // Is there a specified limit?
+  // Bulk review ('review bulk'), and is there a specified limit?
+  bool bulk = args.size () >= 2 && args[1] == "bulk";
   unsigned int limit = 0;
-  if (args.size () == 2)
-    limit = strtol (args[1].c_str (), NULL, 10);
+  if (args.size () == (bulk ? 3u : 2u))
+    limit = strtol (args.back ().c_str (), NULL, 10);
 
   // Configure 'reviewed' UDA, but only if necessary.
-  std::string input;
-  std::string output;
-  auto status = execute ("task", {"_get", "rc.uda.reviewed.type"}, input, output);
-  if (status || output != "date\n")
+  if (config.get ("uda.reviewed.type") != "date")
   {
     if (confirm ("Tasksh needs to define a 'reviewed' UDA of type 'date' for all tasks.  Ok to proceed?"))
     {
-      execute ("task", {"rc.confirmation:no", "rc.verbose:nothing", "config", "uda.reviewed.type",  "date"},     input, output);
-      execute ("task", {"rc.confirmation:no", "rc.verbose:nothing", "config", "uda.reviewed.label", "Reviewed"}, input, output);
+      config.set ("uda.reviewed.type",  "date");
+      config.set ("uda.reviewed.label", "Reviewed");
     }
   }
 
   // Configure '_reviewed' report, but only if necessary.
-  status = execute ("task", {"_get", "rc.report._reviewed.columns"}, input, output);
-  if (status || output != "uuid\n")
+  if (config.get ("report._reviewed.columns") != "uuid")
   {
     if (confirm ("Tasksh needs to define a '_reviewed' report to identify tasks needing review.  Ok to proceed?"))
     {
-      execute ("task", {"rc.confirmation:no", "rc.verbose:nothing", "config", "report._reviewed.description",
-                        "Tasksh review report.  Adjust the filter to your needs."                                              }, input, output);
-      execute ("task", {"rc.confirmation:no", "rc.verbose:nothing", "config", "report._reviewed.columns", "uuid"               }, input, output);
-      execute ("task", {"rc.confirmation:no", "rc.verbose:nothing", "config", "report._reviewed.sort",    "reviewed+,modified+"}, input, output);
-      execute ("task", {"rc.confirmation:no", "rc.verbose:nothing", "config", "report._reviewed.filter",
-                        "( reviewed.none: or reviewed.before:now-6days ) and ( +PENDING or +WAITING )"                         }, input, output);
+      config.set ("report._reviewed.description", "Tasksh review report.  Adjust the filter to your needs.");
+      config.set ("report._reviewed.columns",     "uuid");
+      config.set ("report._reviewed.sort",        "reviewed+,modified+");
+      config.set ("report._reviewed.filter",      "( reviewed.none: or reviewed.before:now-6days ) and ( +PENDING or +WAITING )");
     }
   }
 
-  // Obtain a list of UUIDs to review.
-  status = execute ("task",
-                    {
-                      "rc.color=off",
-                      "rc.detection=off",
-                      "rc._forcecolor=off",
-                      "rc.verbose=nothing",
-                      "_reviewed"
-                    },
-                    input, output);
+  // Review actions are written in the background.  Any that an earlier session
+  // did not write are written first, as they change what needs review.
+  // Without a journal, for example in a read-only data directory, or while
+  // another session is reviewing, they are written as before.
+  // Their writes are told apart from changes made elsewhere by the data
+  // signature, which the worker obtains without the configuration.
+  auto location = config.dataLocation ();
+  WriteQueue writes;
+  writes.signature ([location] { return watcher.dataSignature (location); });
+
+  auto journal = location + "/tasksh.journal";
+  unsigned int recovered;
+  if (! writes.background (journal, recovered))
+    std::cerr << format ("Could not use the journal '{1}', so changes are written before continuing.", journal) << "\n";
+
+  if (recovered)
+  {
+    std::cout << format ("Writing {1} changes left from an earlier session.", recovered) << "\n";
+    writes.drain ();
+    reportFailures (writes);
+  }
+
+  // Resume the last session, or fetch the first page of tasks to review, and
+  // their metadata.  Only the first 'limit' tasks can be shown, so no more are
+  // fetched.
+  auto filter = config.get ("report._reviewed.filter");
+  auto checkpoint = config.dataLocation () + "/tasksh.review";
+  auto resume = config.getInteger ("tasksh.review.resume", defaultResume);
+
+  ReviewQueue queue (limit, reviewPage, loadTasks);
+  if (resume <= 0 ||
+      ! queue.resume (checkpoint, filter, watcher.dataSignature (), resume))
+    queue.start (filter);
+
+  // How many review actions to buffer before writing.
+  unsigned int batch = config.getInteger ("tasksh.review.batch", defaultBatch);
+
+  // How many tasks to render ahead.
+  unsigned int prefetch = config.getInteger ("tasksh.review.prefetch", defaultPrefetch);
+
+  // How to display task details.
+  bool native = config.get ("tasksh.review.information") != "task";
 
   // Review the set of UUIDs.
-  auto uuids = split (Lexer::trimRight (output, "\n"), '\n');
-  reviewLoop (uuids, limit, autoClear);
+  auto stopped = bulk ? bulkLoop (queue, writes, limit, config.getInteger ("tasksh.review.page", defaultPage), autoClear)
+                      : reviewLoop (queue, writes, limit, batch, prefetch, native, autoClear);
+
+  // Remember the rest, to resume from.  The review's own writes are done, so
+  // they are not taken for changes made elsewhere.
+  if (resume > 0)
+    queue.save (checkpoint, filter, watcher.dataSignature (), stopped);
+
   return 0;
 }
 
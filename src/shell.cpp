@@ -29,18 +29,42 @@
 #include <string>
 #include <stdlib.h>
 #include <shared.h>
+#include <process.h>
+#include <Executor.h>
 
 ////////////////////////////////////////////////////////////////////////////////
-int cmdShell (const std::vector <std::string>& args)
+int cmdShell (const std::string& command)
 {
-  auto combined = join (" ", args);
+  auto combined = command;
 
   // Support '!ls' as well as '! ls'.
   if (combined[0] == '!')
     combined = combined.substr (1);
 
-  system (combined.c_str ());
-  return 0; // Ignore system return code.
+  // Commands that need the shell (pipes, redirection, globbing, variables...)
+  // are given to /bin/sh, but plain commands are run directly, saving a
+  // process.
+  if (needsShell (combined))
+  {
+    executor ().run ("/bin/sh", {"-c", combined});
+  }
+  else
+  {
+    auto args = tokenize (combined);
+
+    // Strip the 'exec' keyword, which the shell would otherwise interpret.
+    if (args.size () && closeEnough ("exec", args[0], 3))
+      args.erase (args.begin ());
+
+    if (args.size ())
+    {
+      auto executable = args[0];
+      args.erase (args.begin ());
+      executor ().run (executable, args);
+    }
+  }
+
+  return 0; // Ignore child return code.
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,111 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <Accounting.h>
+#include <Color.h>
+#include <format.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Nearest-rank percentile of sorted values.
+static double percentile (const std::vector <double>& sorted, double p)
+{
+  auto rank = (size_t) std::ceil (p * sorted.size ());
+  return sorted[rank ? rank - 1 : 0];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static std::string milliseconds (double seconds)
+{
+  return format ("{1}", (long) std::round (seconds * 1000.0));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Latency percentiles, CPU time and peak memory of the processes run during
+// the session, by command.  Times are in milliseconds.
+int cmdStats ()
+{
+  auto commands = accounting.commands ();
+  if (commands.size () == 0)
+  {
+    std::cout << "No processes have been run.\n";
+    return 0;
+  }
+
+  Color bold ("bold");
+  std::cout << '\n'
+            << bold.colorize (leftJustify ("Command", 24)
+                              + rightJustify ("Runs",    6)
+                              + rightJustify ("p50",     8)
+                              + rightJustify ("p95",     8)
+                              + rightJustify ("p99",     8)
+                              + rightJustify ("Total",   9)
+                              + rightJustify ("Spawn",   7)
+                              + rightJustify ("User",    8)
+                              + rightJustify ("Sys",     8)
+                              + rightJustify ("Max RSS", 12))
+            << '\n';
+
+  size_t runs = 0;
+  double total = 0.0;
+  double cpu = 0.0;
+  for (auto& command : commands)
+  {
+    auto& latencies = command.second.latencies;
+    std::sort (latencies.begin (), latencies.end ());
+
+    double sum = 0.0;
+    for (auto latency : latencies)
+      sum += latency;
+
+    std::cout << leftJustify (command.first, 24)
+              << rightJustify ((int) latencies.size (), 6)
+              << rightJustify (milliseconds (percentile (latencies, 0.50)), 8)
+              << rightJustify (milliseconds (percentile (latencies, 0.95)), 8)
+              << rightJustify (milliseconds (percentile (latencies, 0.99)), 8)
+              << rightJustify (milliseconds (sum), 9)
+              << rightJustify (milliseconds (command.second.spawn), 7)
+              << rightJustify (milliseconds (command.second.user), 8)
+              << rightJustify (milliseconds (command.second.system), 8)
+              << rightJustify (formatBytes (command.second.maxRSS * 1024), 12)
+              << '\n';
+
+    runs  += latencies.size ();
+    total += sum;
+    cpu   += command.second.user + command.second.system;
+  }
+
+  std::cout << '\n'
+            << format ("{1} processes, {2} ms elapsed, {3} ms CPU.", runs, milliseconds (total), milliseconds (cpu))
+            << "\n\n";
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,301 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <FakeExecutor.h>
+#include <process.h>
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////////////////
+// The fake holds a fixed set of tasks, generated from their index, and
+// supports just enough commands for tasksh: _show, _get, _reviewed and _uuids
+// (with 'limit:'), count, export, information, modify, done, delete,
+// annotate, config and reports.
+static std::string uuidFor (unsigned int index)
+{
+  char buffer[37];
+  snprintf (buffer, sizeof (buffer), "%08x-0000-4000-8000-%012x", index + 1, index + 1);
+  return buffer;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Task numbers are recovered from UUIDs, or IDs.  Returns -1 for other words.
+static int indexFor (const std::string& word, unsigned int tasks)
+{
+  unsigned int index;
+  char rest;
+  if (word.length () == 36 && sscanf (word.c_str (), "%8x-%c", &index, &rest) == 2)
+    return index >= 1 && index <= tasks ? index - 1 : -1;
+
+  if (word.find_first_not_of ("0123456789") == std::string::npos &&
+      sscanf (word.c_str (), "%u", &index) == 1)
+    return index >= 1 && index <= tasks ? index - 1 : -1;
+
+  return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static std::string exportTask (unsigned int index)
+{
+  char buffer[512];
+  snprintf (buffer, sizeof (buffer),
+            "{\"id\":%u,\"description\":\"Benchmark task %u\",\"entry\":\"20170101T000000Z\","
+            "\"modified\":\"20170102T000000Z\",\"project\":\"Project%u\",\"status\":\"pending\","
+            "\"tags\":[\"tag%u\",\"group%u\"],\"uuid\":\"%s\",\"urgency\":%u.%u}",
+            index + 1, index + 1, index % 10, index % 7, index % 13,
+            uuidFor (index).c_str (), index % 20, index % 10);
+  return buffer;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static void information (std::ostream& out, unsigned int index)
+{
+  out << "\n"
+      << "Name          Value\n"
+      << "------------- ------------------------------------\n"
+      << "ID            " << index + 1 << "\n"
+      << "Description   Benchmark task " << index + 1 << "\n"
+      << "Status        Pending\n"
+      << "Project       Project" << index % 10 << "\n"
+      << "Entered       2017-01-01 00:00:00\n"
+      << "Last modified 2017-01-02 00:00:00\n"
+      << "Tags          tag" << index % 7 << " group" << index % 13 << "\n"
+      << "UUID          " << uuidFor (index) << "\n"
+      << "Urgency       " << index % 20 << "." << index % 10 << "\n"
+      << "\n";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Settings are those in $TASKRC, one 'name=value' per line.
+static void show (std::ostream& out)
+{
+  bool location = false;
+  auto rc = getenv ("TASKRC");
+  if (rc)
+  {
+    std::ifstream file (rc);
+    std::string line;
+    while (std::getline (file, line))
+      if (line.length () && line[0] != '#' && line.find ('=') != std::string::npos)
+      {
+        out << line << "\n";
+        if (line.compare (0, 14, "data.location=") == 0)
+          location = true;
+      }
+  }
+
+  auto data = getenv ("TASKDATA");
+  if (! location && data)
+    out << "data.location=" << data << "\n";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+FakeExecutor::FakeExecutor (std::unique_ptr <Executor> inner, unsigned int tasks, unsigned int latency)
+: _inner (std::move (inner))
+, _tasks (tasks)
+, _latency (latency)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int FakeExecutor::run (
+  const std::string& exe,
+  const std::vector <std::string>& args)
+{
+  if (exe != "task")
+    return _inner->run (exe, args);
+
+  std::string output;
+  auto status = task (args, output);
+  std::cout << output << std::flush;
+  return status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int FakeExecutor::runPty (
+  const std::string& exe,
+  const std::vector <std::string>& args,
+  unsigned short width,
+  unsigned short height,
+  std::string& output,
+  std::string::size_type limit)
+{
+  if (exe != "task")
+    return _inner->runPty (exe, args, width, height, output, limit);
+
+  auto status = task (args, output);
+  std::cout << output << std::flush;
+  return status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int FakeExecutor::capture (
+  const std::string& exe,
+  const std::vector <std::string>& args,
+  std::string& output,
+  int timeout)
+{
+  if (exe != "task")
+    return _inner->capture (exe, args, output, timeout);
+
+  return task (args, output);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int FakeExecutor::collect (
+  const std::string& exe,
+  const std::vector <std::string>& args,
+  std::string& output,
+  std::string& errors)
+{
+  if (exe != "task")
+    return _inner->collect (exe, args, output, errors);
+
+  errors = "";
+  return task (args, output);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int FakeExecutor::stream (
+  const std::string& exe,
+  const std::vector <std::string>& args,
+  std::function <bool (const std::string&)> handler)
+{
+  if (exe != "task")
+    return _inner->stream (exe, args, handler);
+
+  std::string output;
+  auto status = task (args, output);
+
+  LineReader reader (handler);
+  reader.feed (output.data (), output.size ());
+  reader.finish ();
+  return status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Runs one Taskwarrior command against the fake tasks.
+int FakeExecutor::task (const std::vector <std::string>& args, std::string& output) const
+{
+  if (_latency)
+    std::this_thread::sleep_for (std::chrono::milliseconds (_latency));
+
+  // Separate the command from the tasks it applies to.  Any other filter is
+  // ignored.
+  std::string command;
+  std::vector <int> selected;
+  std::vector <std::string> words;
+  for (auto& arg : args)
+  {
+    if (arg.compare (0, 3, "rc.") == 0)
+      continue;
+
+    if (command == "" &&
+        (arg == "(" || arg == ")" || arg == "and" || arg == "or" ||
+         arg.find (':') != std::string::npos ||
+         (arg.length () > 1 && (arg[0] == '+' || (arg[0] == '-' && arg[1] != '-')))))
+      continue;
+
+    int index = indexFor (arg, _tasks);
+    if (command == "" && index != -1)
+      selected.push_back (index);
+    else if (command == "")
+      command = arg;
+    else
+      words.push_back (arg);
+  }
+
+  std::stringstream out;
+  if (command == "--version")
+  {
+    out << "2.5.1\n";
+  }
+  else if (command == "_show")
+  {
+    show (out);
+  }
+  else if (command == "_get")
+  {
+    out << "\n";
+  }
+  else if (command == "_reviewed" || command == "_uuids")
+  {
+    unsigned int limit = _tasks;
+    for (auto& word : words)
+      if (word.compare (0, 6, "limit:") == 0)
+        limit = std::min (limit, (unsigned int) strtoul (word.c_str () + 6, NULL, 10));
+
+    for (unsigned int i = 0; i < limit; ++i)
+      out << uuidFor (i) << "\n";
+  }
+  else if (command == "count")
+  {
+    out << (selected.size () ? selected.size () : _tasks) << "\n";
+  }
+  else if (command == "export")
+  {
+    out << "[\n";
+    if (selected.size ())
+      for (unsigned int i = 0; i < selected.size (); ++i)
+        out << (i ? ",\n" : "") << exportTask (selected[i]);
+    else
+      for (unsigned int i = 0; i < _tasks; ++i)
+        out << (i ? ",\n" : "") << exportTask (i);
+    out << "\n]\n";
+  }
+  else if (command == "information" || command == "info")
+  {
+    for (auto index : selected)
+      information (out, index);
+  }
+  else if (command == "modify"   ||
+           command == "done"     ||
+           command == "delete"   ||
+           command == "annotate" ||
+           command == "config")
+  {
+    // Writes produce no output with rc.verbose=nothing.
+  }
+  else
+  {
+    // Any other command is treated as a report of the first few tasks.
+    for (unsigned int i = 0; i < _tasks && i < 25; ++i)
+      out << i + 1 << " Benchmark task " << i + 1 << "\n";
+  }
+
+  output = out.str ();
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,57 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_FAKEEXECUTOR
+#define INCLUDED_FAKEEXECUTOR
+
+#include <Executor.h>
+
+// Answers Taskwarrior commands in-process, from a fixed set of generated
+// tasks, after an optional delay in milliseconds.  For benchmarking tasksh
+// without Taskwarrior, so it is only built with the tests, into faketask.
+class FakeExecutor : public Executor
+{
+public:
+  FakeExecutor (std::unique_ptr <Executor>, unsigned int, unsigned int);
+
+  int run     (const std::string&, const std::vector <std::string>&) override;
+  int runPty  (const std::string&, const std::vector <std::string>&, unsigned short, unsigned short, std::string&, std::string::size_type limit = std::string::npos) override;
+  int capture (const std::string&, const std::vector <std::string>&, std::string&, int timeout = 0) override;
+  int collect (const std::string&, const std::vector <std::string>&, std::string&, std::string&) override;
+  int stream  (const std::string&, const std::vector <std::string>&, std::function <bool (const std::string&)>) override;
+
+  int task (const std::vector <std::string>&, std::string&) const;
+
+private:
+  std::unique_ptr <Executor> _inner;
+  unsigned int               _tasks;
+  unsigned int               _latency;
+};
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
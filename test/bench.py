@@ -0,0 +1,187 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+###############################################################################
+#
+# Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# http://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+
+"""Benchmarks tasksh against a fake 'task', and reports the results as JSON.
+
+Measures:
+  startup_ms             Start and exit with nothing to do.
+  command_overhead_ms    Added per Taskwarrior command, over the fake's latency.
+  review_tasks_per_min   Review throughput, marking every task reviewed.
+  max_rss_kb             Peak memory of tasksh, or its children, in any run.
+"""
+
+from __future__ import print_function
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+TASKSH = os.path.abspath(os.path.join(HERE, "..", "src", "tasksh"))
+FAKETASK = os.path.join(HERE, "faketask")
+
+# Lower is better for these, higher for the rest.
+LOWER_IS_BETTER = ("startup_ms", "command_overhead_ms", "max_rss_kb")
+
+
+class Bench(object):
+    """An isolated environment, with 'task' being the fake."""
+
+    def __init__(self, tasks, latency, tasksh=TASKSH, faketask=FAKETASK):
+        self.tasksh = tasksh
+        self.dir = tempfile.mkdtemp(prefix="tasksh_bench_")
+        self.max_rss = 0
+
+        bindir = os.path.join(self.dir, "bin")
+        os.mkdir(bindir)
+        os.symlink(faketask, os.path.join(bindir, "task"))
+
+        taskrc = os.path.join(self.dir, "taskrc")
+        with open(taskrc, "w") as rc:
+            rc.write("uda.reviewed.type=date\n"
+                     "report._reviewed.columns=uuid\n"
+                     "report._reviewed.filter=reviewed.none:\n"
+                     "tasksh.batch.jobs=1\n")
+
+        self.env = os.environ.copy()
+        self.env.update({
+            "PATH": bindir + os.pathsep + self.env.get("PATH", ""),
+            "TASKRC": taskrc,
+            "TASKDATA": self.dir,
+            "FAKETASK_TASKS": str(tasks),
+            "FAKETASK_LATENCY": str(latency),
+        })
+
+    def destroy(self):
+        shutil.rmtree(self.dir, ignore_errors=True)
+
+    def run(self, script):
+        """Runs a script in batch mode, and returns the elapsed seconds."""
+        start = time.time()
+        p = subprocess.Popen([self.tasksh], stdin=subprocess.PIPE,
+                             stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                             env=self.env)
+        p.stdin.write(script.encode("utf-8"))
+        p.stdin.close()
+        p.stdout.read()
+        p.stderr.read()
+        # Reaped here rather than by Popen, to obtain the resource usage.
+        _, status, usage = os.wait4(p.pid, 0)
+        elapsed = time.time() - start
+        p.returncode = os.WEXITSTATUS(status) if os.WIFEXITED(status) else -1
+
+        self.max_rss = max(self.max_rss, usage.ru_maxrss)
+        if p.returncode != 0:
+            raise RuntimeError("tasksh failed with status {0}".format(p.returncode))
+
+        return elapsed
+
+    def median(self, script, runs):
+        times = sorted(self.run(script) for _ in range(runs))
+        return times[len(times) // 2]
+
+
+def measure(tasks=100, latency=0, commands=100, runs=5,
+            tasksh=TASKSH, faketask=FAKETASK):
+    bench = Bench(tasks, latency, tasksh, faketask)
+    try:
+        startup = bench.median("", runs)
+        script = "_get rc.data.location\n" * commands
+        command = bench.median(script, runs)
+        review = bench.median("review\n" + "r\n" * tasks, runs)
+
+        overhead = (command - startup) / commands - latency / 1000.0
+        return {
+            "tasks": tasks,
+            "latency_ms": latency,
+            "startup_ms": round(startup * 1000.0, 3),
+            "command_overhead_ms": round(max(overhead, 0.0) * 1000.0, 3),
+            "review_tasks_per_min": round(tasks / (review - startup) * 60.0, 1),
+            "max_rss_kb": bench.max_rss,
+        }
+    finally:
+        bench.destroy()
+
+
+def regressions(results, baseline, threshold):
+    """Names of the measurements that are worse than the baseline by more
+    than the threshold ratio."""
+    worse = []
+    for name in LOWER_IS_BETTER + ("review_tasks_per_min",):
+        if name not in baseline or not baseline[name] or name not in results:
+            continue
+
+        if name in LOWER_IS_BETTER:
+            ratio = results[name] / float(baseline[name])
+        else:
+            ratio = baseline[name] / float(max(results[name], 0.001))
+
+        if ratio > threshold:
+            worse.append(name)
+
+    return worse
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark tasksh")
+    parser.add_argument("--tasks", type=int, default=1000,
+                        help="Number of tasks the fake holds")
+    parser.add_argument("--latency", type=int, default=0,
+                        help="Milliseconds the fake takes per command")
+    parser.add_argument("--commands", type=int, default=200,
+                        help="Commands run to measure overhead")
+    parser.add_argument("--runs", type=int, default=5,
+                        help="Runs of each measurement, of which the median is used")
+    parser.add_argument("--output", help="Write JSON results to this file")
+    parser.add_argument("--baseline",
+                        help="Baseline JSON file, written if it does not exist")
+    args = parser.parse_args()
+
+    results = measure(args.tasks, args.latency, args.commands, args.runs)
+    text = json.dumps(results, indent=2, sort_keys=True)
+    print(text)
+
+    if args.output:
+        with open(args.output, "w") as fh:
+            fh.write(text + "\n")
+
+    if args.baseline and not os.path.exists(args.baseline):
+        with open(args.baseline, "w") as fh:
+            fh.write(text + "\n")
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
+
+# vim: ai sts=4 et sw=4 ft=python
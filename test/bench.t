@@ -0,0 +1,73 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+###############################################################################
+#
+# Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# http://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+
+import sys
+import os
+import json
+import unittest
+# Ensure python finds the local simpletap module
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+
+from basetest import TestCase
+from bench import measure, regressions, FAKETASK, TASKSH
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+BASELINE = os.path.join(HERE, "bench.baseline.json")
+
+# A measurement this many times worse than the baseline is a regression.
+THRESHOLD = float(os.environ.get("TASKSH_BENCH_THRESHOLD", "1.5"))
+
+
+class TestBenchmark(TestCase):
+    def test_no_regression(self):
+        """Verify that performance has not regressed beyond the baseline"""
+        if not os.path.exists(FAKETASK) or not os.path.exists(TASKSH):
+            self.skipTest("tasksh and faketask must be built")
+
+        if not os.path.exists(BASELINE):
+            self.skipTest("no baseline, run 'make bench' to record one")
+
+        with open(BASELINE) as fh:
+            baseline = json.load(fh)
+
+        results = measure(tasks=baseline["tasks"],
+                          latency=baseline["latency_ms"],
+                          commands=50,
+                          runs=3)
+
+        worse = regressions(results, baseline, THRESHOLD)
+        self.assertEqual(worse, [],
+                         "Regressed: {0}\nBaseline: {1}\nResults: {2}".format(
+                             ", ".join(worse), baseline, results))
+
+
+if __name__ == "__main__":
+    from simpletap import TAPTestRunner
+    unittest.main(testRunner=TAPTestRunner())
+
+# vim: ai sts=4 et sw=4 ft=python
@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <string>
+#include <vector>
+#include <Executor.h>
+#include <Completion.h>
+#include <test.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Knows three tasks, and nothing else.
+class UuidExecutor : public Executor
+{
+public:
+  int run (const std::string&, const std::vector <std::string>&) override
+  {
+    return 0;
+  }
+
+  int runPty (const std::string&, const std::vector <std::string>&, unsigned short, unsigned short, std::string&, std::string::size_type) override
+  {
+    return 0;
+  }
+
+  int capture (const std::string&, const std::vector <std::string>&, std::string& output, int) override
+  {
+    output = "";
+    return 0;
+  }
+
+  int collect (const std::string&, const std::vector <std::string>&, std::string& output, std::string& errors) override
+  {
+    output = errors = "";
+    return 0;
+  }
+
+  int stream (const std::string&, const std::vector <std::string>& args, std::function <bool (const std::string&)> handler) override
+  {
+    if (args.back () == "_uuids")
+      for (auto uuid : {"12345678-0000-4000-8000-000000000001",
+                        "a1b2c3d4-0000-4000-8000-000000000002",
+                        "a1ffffff-0000-4000-8000-000000000003"})
+        handler (uuid);
+
+    return 0;
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+int main (int, char**)
+{
+  UnitTest t (8);
+
+  selectExecutor (std::unique_ptr <Executor> (new UuidExecutor ()));
+
+  Completion completion;
+  t.is (completion.complete ("a1", false).size (), (size_t) 2,        "complete: 'a1' -> 2 UUIDs");
+  t.is (completion.complete ("a1b", false).size (), (size_t) 1,       "complete: 'a1b' -> 1 UUID");
+  t.is (completion.complete ("a1b", false)[0], "a1b2c3d4-0000-4000-8000-000000000002",
+                                                                       "complete: 'a1b' -> a1b2c3d4-...");
+  t.is (completion.complete ("A1B", false).size (), (size_t) 1,       "complete: 'A1B' -> 1 UUID");
+  t.is (completion.complete ("a", false).size (), (size_t) 0,         "complete: 'a' -> too short");
+  t.is (completion.complete ("12", false).size (), (size_t) 0,        "complete: '12' -> an ID, not a UUID");
+  t.is (completion.complete ("12345678", false).size (), (size_t) 0,  "complete: '12345678' -> an ID, not a UUID");
+  t.is (completion.complete ("a1-g", false).size (), (size_t) 0,      "complete: 'a1-g' -> not hex");
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
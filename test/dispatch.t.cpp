@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <Executor.h>
+#include <dispatch.h>
+#include <shared.h>
+#include <test.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Answers every command after a short delay, and logs when each starts and
+// finishes, as '+<command>' and '-<command>'.
+class LogExecutor : public Executor
+{
+public:
+  int run (const std::string&, const std::vector <std::string>&) override
+  {
+    return 0;
+  }
+
+  int runPty (const std::string&, const std::vector <std::string>&, unsigned short, unsigned short, std::string&, std::string::size_type) override
+  {
+    return 0;
+  }
+
+  int capture (const std::string&, const std::vector <std::string>& args, std::string& output, int) override
+  {
+    output = "";
+    if (args.size () == 1 && args[0] == "_show")
+      output = "gc=on\n"
+               "report.list.columns=id,description\n";
+    return 0;
+  }
+
+  int collect (const std::string&, const std::vector <std::string>& args, std::string& output, std::string& errors) override
+  {
+    auto command = join (" ", args);
+    log ("+" + command);
+    std::this_thread::sleep_for (std::chrono::milliseconds (20));
+    log ("-" + command);
+
+    output = command;
+    errors = "";
+    return 0;
+  }
+
+  int stream (const std::string&, const std::vector <std::string>&, std::function <bool (const std::string&)>) override
+  {
+    return 0;
+  }
+
+  // Position of the event in the log, or -1.
+  int position (const std::string& event)
+  {
+    std::lock_guard <std::mutex> lock (_mutex);
+    auto found = std::find (_events.begin (), _events.end (), event);
+    return found == _events.end () ? -1 : found - _events.begin ();
+  }
+
+  void clear ()
+  {
+    std::lock_guard <std::mutex> lock (_mutex);
+    _events.clear ();
+  }
+
+private:
+  void log (const std::string& event)
+  {
+    std::lock_guard <std::mutex> lock (_mutex);
+    _events.push_back (event);
+  }
+
+private:
+  std::vector <std::string> _events {};
+  std::mutex                _mutex  {};
+};
+
+////////////////////////////////////////////////////////////////////////////////
+int main (int, char**)
+{
+  UnitTest t (11);
+
+  auto log = new LogExecutor ();
+  selectExecutor (std::unique_ptr <Executor> (log));
+
+  std::vector <std::string> outputs;
+  auto emit = [&outputs] (size_t, const std::string& output, const std::string&)
+  {
+    outputs.push_back (output);
+  };
+
+  // A report first: it runs alone, and everything after it runs without
+  // garbage collection or recurrence.
+  cmdTasks ({{"list"}, {"count"}, {"list"}}, 4, emit);
+  t.is (outputs.size (), (size_t) 3,                        "cmdTasks: report first -> 3 results");
+  t.is (outputs[0], "list",                                 "cmdTasks: report first -> runs as written");
+  t.is (outputs[1], "rc.gc=off rc.recurrence=off count",    "cmdTasks: report first -> count follows without GC");
+  t.is (outputs[2], "rc.gc=off rc.recurrence=off list",     "cmdTasks: report first -> report follows without GC");
+  t.ok (log->position ("-list") < log->position ("+rc.gc=off rc.recurrence=off count"),
+                                                            "cmdTasks: report first -> finishes before the rest start");
+
+  // A helper and a count first: neither collects garbage, so the report
+  // after them still does, once they have finished.
+  outputs.clear ();
+  log->clear ();
+  cmdTasks ({{"_get", "1.description"}, {"count"}, {"list"}, {"list"}}, 4, emit);
+  t.is (outputs.size (), (size_t) 4,                        "cmdTasks: helper first -> 4 results");
+  t.is (outputs[0], "_get 1.description",                   "cmdTasks: helper first -> helper runs as written");
+  t.is (outputs[1], "count",                                "cmdTasks: helper first -> count runs as written");
+  t.is (outputs[2], "list",                                 "cmdTasks: helper first -> first report runs as written");
+  t.is (outputs[3], "rc.gc=off rc.recurrence=off list",     "cmdTasks: helper first -> second report follows without GC");
+  t.ok (log->position ("-_get 1.description") < log->position ("+list") &&
+        log->position ("-count")              < log->position ("+list") &&
+        log->position ("-list")               < log->position ("+rc.gc=off rc.recurrence=off list"),
+                                                            "cmdTasks: helper first -> the report runs alone, in order");
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
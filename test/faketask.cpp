@@ -0,0 +1,58 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+// A stand-in for Taskwarrior, for benchmarking tasksh without the cost of
+// real Taskwarrior startup, and with repeatable results.  It runs as a
+// separate process, so that process creation is still measured.
+//
+// Environment:
+//   FAKETASK_TASKS     Number of tasks.  Default 100.
+//   FAKETASK_LATENCY   Milliseconds to sleep before every command.  Default 0.
+//   TASKRC             Settings reported by _show, one 'name=value' per line.
+
+#include <cmake.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <FakeExecutor.h>
+
+////////////////////////////////////////////////////////////////////////////////
+int main (int argc, char** argv)
+{
+  unsigned int tasks = getenv ("FAKETASK_TASKS") ? atoi (getenv ("FAKETASK_TASKS")) : 100;
+  unsigned int latency = getenv ("FAKETASK_LATENCY") ? atoi (getenv ("FAKETASK_LATENCY")) : 0;
+
+  FakeExecutor fake (std::unique_ptr <Executor> (new SpawnExecutor ()), tasks, latency);
+
+  std::string output;
+  auto status = fake.task (std::vector <std::string> (argv + 1, argv + argc), output);
+  std::cout << output;
+  return status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <format.h>
+
+int promptClear ();
+int promptRemove ();
+int promptAdd (const std::string&);
+const std::string& promptCompose ();
+
+////////////////////////////////////////////////////////////////////////////////
+// Nanoseconds per call of a function, over enough calls to be measurable.
+template <typename F>
+static double measure (F function)
+{
+  const int iterations = 100000;
+  auto start = std::chrono::steady_clock::now ();
+  for (int i = 0; i < iterations; ++i)
+    function ();
+
+  auto elapsed = std::chrono::steady_clock::now () - start;
+  return std::chrono::duration_cast <std::chrono::nanoseconds> (elapsed).count () / (double) iterations;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Prompt composition cost with 1, 10 and 100 stacked contexts, both for an
+// unchanged prompt, and for a prompt following a context push and pop.
+int main (int, char**)
+{
+  std::cout << "contexts  compose (ns)  push/pop/compose (ns)\n";
+
+  for (int depth : {1, 10, 100})
+  {
+    promptClear ();
+    for (int i = 0; i < depth; ++i)
+      promptAdd (format ("context{1}", i));
+
+    size_t length = 0;
+    auto compose = measure ([&length] { length += promptCompose ().length (); });
+    auto change  = measure ([&length] { promptAdd ("extra");
+                                        promptRemove ();
+                                        length += promptCompose ().length (); });
+
+    std::cout << rightJustify (depth, 8)
+              << rightJustify ((int) compose, 14)
+              << rightJustify ((int) change, 23)
+              << "\n";
+  }
+
+  promptClear ();
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <string>
+#include <test.h>
+
+int promptClear ();
+int promptRemove ();
+int promptAdd (const std::string&);
+const std::string& composeContexts (bool);
+const std::string& promptCompose ();
+
+////////////////////////////////////////////////////////////////////////////////
+int main (int, char**)
+{
+  UnitTest t (9);
+
+  promptClear ();
+  t.is (composeContexts (false), "",           "prompt: no contexts -> ''");
+  t.is (promptCompose (), "tasksh> ",           "prompt: no contexts -> 'tasksh> '");
+
+  promptAdd ("one");
+  promptAdd ("two");
+  t.is (composeContexts (false), "one two ",   "prompt: two contexts -> 'one two '");
+  t.ok (promptCompose ().find ("task ") == 0,  "prompt: contexts -> 'task ...'");
+
+  auto pretty = composeContexts (true);
+  auto prompt = promptCompose ();
+  promptAdd ("three");
+  t.is (composeContexts (false), "one two three ", "prompt: three contexts -> 'one two three '");
+
+  promptRemove ();
+  t.is (composeContexts (false), "one two ",   "prompt: remove -> 'one two '");
+  t.is (composeContexts (true), pretty,        "prompt: remove restores the colored contexts");
+  t.is (promptCompose (), prompt,              "prompt: remove restores the prompt");
+
+  promptClear ();
+  t.is (promptCompose (), "tasksh> ",           "prompt: clear -> 'tasksh> '");
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
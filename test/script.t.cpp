@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <sstream>
+#include <Script.h>
+#include <test.h>
+
+////////////////////////////////////////////////////////////////////////////////
+int main (int, char**)
+{
+  UnitTest t (12);
+
+  std::stringstream input;
+  input << "# A comment\n"
+        << "12 modify +work\n"
+        << "\n"
+        << "13 modify +work\n"
+        << "14-16 modify +work\n"
+        << "17 modify +home\n"
+        << "a1b2c3d4 done\n"
+        << "01234567-89ab-cdef-0123-456789abcdef done\n"
+        << "list\n"
+        << "18 project:x modify +work\n"
+        << "19 project:x modify +work\n"
+        << "20 annotate 'a note'\n";
+
+  Script script;
+  script.load (input);
+  t.ok (script.active (),                                     "script: active after load");
+
+  std::string command;
+  t.ok (script.take (command),                                "script: take 1");
+  t.is (command, "rc.bulk=0 12 13 14-16 modify +work",        "script: identical modifications are merged");
+
+  script.take (command);
+  t.is (command, "17 modify +home",                           "script: a different modification is not merged");
+
+  script.take (command);
+  t.is (command, "rc.bulk=0 a1b2c3d4 01234567-89ab-cdef-0123-456789abcdef done",
+                                                              "script: UUIDs are merged");
+
+  script.take (command);
+  t.is (command, "list",                                      "script: reports are not merged");
+
+  script.take (command);
+  t.is (command, "18 project:x modify +work",                 "script: lines with other filter terms are not merged");
+
+  script.take (command);
+  t.is (command, "19 project:x modify +work",                 "script: lines with other filter terms are not merged");
+
+  t.ok (script.next (command),                                "script: next");
+  t.is (command, "20 annotate 'a note'",                      "script: next returns the line as written");
+
+  t.notok (script.take (command),                             "script: exhausted");
+  t.is ((int) script.lines (), 10,                            "script: 10 lines taken");
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,146 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <vector>
+#include <string>
+#include <process.h>
+#include <test.h>
+
+////////////////////////////////////////////////////////////////////////////////
+int main (int, char**)
+{
+  UnitTest t (40);
+
+  // Plain words.
+  auto args = tokenize ("list project:Home +tag");
+  t.is (args.size (), (size_t) 3,          "tokenize: 'list project:Home +tag' -> 3 args");
+  t.is (args[0], "list",                   "tokenize: [0] list");
+  t.is (args[1], "project:Home",           "tokenize: [1] project:Home");
+  t.is (args[2], "+tag",                   "tokenize: [2] +tag");
+
+  // Surrounding whitespace.
+  args = tokenize ("  next   \t ");
+  t.is (args.size (), (size_t) 1,          "tokenize: '  next   \\t ' -> 1 arg");
+  t.is (args[0], "next",                   "tokenize: [0] next");
+
+  // Quoted descriptions remain one argument.
+  args = tokenize ("add 'Buy milk and eggs' due:eom");
+  t.is (args.size (), (size_t) 3,          "tokenize: single quotes -> 3 args");
+  t.is (args[1], "Buy milk and eggs",      "tokenize: [1] Buy milk and eggs");
+
+  args = tokenize ("add \"Say \\\"hi\\\" to Bob\"");
+  t.is (args.size (), (size_t) 2,          "tokenize: double quotes with escapes -> 2 args");
+  t.is (args[1], "Say \"hi\" to Bob",      "tokenize: [1] Say \"hi\" to Bob");
+
+  // Quotes mid-argument.
+  args = tokenize ("1 modify description:\"a b\"");
+  t.is (args.size (), (size_t) 3,          "tokenize: mid-argument quotes -> 3 args");
+  t.is (args[2], "description:a b",        "tokenize: [2] description:a b");
+
+  // Escapes, empty quotes.
+  args = tokenize ("a\\ b ''");
+  t.is (args.size (), (size_t) 2,          "tokenize: escaped space, empty quotes -> 2 args");
+  t.is (args[0], "a b",                    "tokenize: [0] a b");
+  t.is (args[1], "",                       "tokenize: [1] ''");
+
+  // Nothing.
+  t.is (tokenize ("   ").size (), (size_t) 0, "tokenize: whitespace -> 0 args");
+
+  // Shell syntax, outside single quotes.
+  t.ok (needsShell ("task list | less"),            "needsShell: pipe");
+  t.ok (needsShell ("task export > out.json"),      "needsShell: redirection");
+  t.ok (needsShell ("task add $(date)"),            "needsShell: substitution");
+  t.ok (needsShell ("task add \"$HOME\""),          "needsShell: substitution in double quotes");
+  t.ok (needsShell ("task import *.json"),          "needsShell: glob");
+  t.ok (needsShell ("task add ~/notes"),            "needsShell: tilde");
+  t.ok (needsShell ("FOO=1 ls"),                    "needsShell: assignment");
+  t.notok (needsShell ("task add 'a | b > c'"),     "needsShell: quoted pipe");
+  t.notok (needsShell ("task add a\\|b"),           "needsShell: escaped pipe");
+  t.notok (needsShell ("task rc.gc=off list"),      "needsShell: override");
+  t.notok (needsShell ("task list ( +a or +b )"),   "needsShell: filter parentheses");
+  t.notok (needsShell ("task add issue#12"),        "needsShell: '#' mid-word");
+
+  // Lines split across pieces, and an unterminated last line.
+  std::vector <std::string> lines;
+  LineReader reader ([&lines] (const std::string& line) { lines.push_back (line); return true; });
+  reader.feed ("one\ntw", 6);
+  reader.feed ("o\n\nthr", 6);
+  reader.feed ("ee", 2);
+  reader.finish ();
+  t.is (lines.size (), (size_t) 4,         "LineReader: 4 lines");
+  t.is (lines[1], "two",                   "LineReader: [1] two");
+  t.is (lines[2], "",                      "LineReader: [2] empty");
+  t.is (lines[3], "three",                 "LineReader: [3] three");
+
+  // Nothing more is handed over once the callback declines.
+  lines.clear ();
+  LineReader first ([&lines] (const std::string& line) { lines.push_back (line); return false; });
+  first.feed ("a\nb\nc", 5);
+  first.finish ();
+  t.is (lines.size (), (size_t) 1,         "LineReader: declined after 1 line");
+  t.notok (first.wanted (),                "LineReader: no longer wanted");
+
+  // Children run by the event loop.
+  std::string output;
+  std::string errors;
+  t.is (collect ("sh", {"-c", "echo out; echo err >&2; exit 3"}, output, errors), 3,
+                                           "collect: exit status 3");
+  t.is (output + errors, "out\nerr\n",     "collect: stdout and stderr apart");
+  t.is (capture ("sh", {"-c", "sleep 10"}, output, 100), 124,
+                                           "capture: timeout -> 124");
+
+  // Several children at once, from one thread, and one started by another.
+  EventLoop loop;
+  int finished = 0;
+  for (int i = 0; i < 3; ++i)
+  {
+    EventLoop::Options options;
+    options.output = [&output] (const char* data, size_t size) { output.append (data, size); };
+    options.done   = [&finished, &loop] (int)
+    {
+      if (++finished == 3)
+      {
+        EventLoop::Options last;
+        last.done = [&finished] (int status) { finished += status; };
+        loop.start ("sh", {"-c", "exit 10"}, last);
+      }
+    };
+
+    loop.start ("echo", {std::to_string (i)}, options);
+  }
+
+  output = "";
+  loop.run ();
+  t.is (finished, 13,                      "EventLoop: all children done");
+  t.is (output.length (), (size_t) 6,      "EventLoop: output of each");
+  t.ok (output.find ("1\n") != std::string::npos, "EventLoop: output of child 1");
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
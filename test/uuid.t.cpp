@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <string>
+#include <unordered_set>
+#include <Uuid.h>
+#include <test.h>
+
+////////////////////////////////////////////////////////////////////////////////
+int main (int, char**)
+{
+  UnitTest t (14);
+
+  // Round trip, with upper case folded.
+  Uuid uuid;
+  t.ok (Uuid::parse ("0b2e5f4c-7d1a-4e3b-9c8d-AbCdEf012345", uuid), "parse: mixed case");
+  t.is (uuid.str (), "0b2e5f4c-7d1a-4e3b-9c8d-abcdef012345",       "str: lower case");
+
+  char buffer[37];
+  uuid.text (buffer);
+  t.is (std::string (buffer), uuid.str (),                          "text: same as str");
+
+  // Malformed.
+  t.notok (Uuid::parse ("0b2e5f4c-7d1a-4e3b-9c8d-abcdef01234",  uuid), "parse: too short");
+  t.notok (Uuid::parse ("0b2e5f4c-7d1a-4e3b-9c8d-abcdef0123456", uuid), "parse: too long");
+  t.notok (Uuid::parse ("0b2e5f4c07d1a-4e3b-9c8d-abcdef012345", uuid), "parse: missing dash");
+  t.notok (Uuid::parse ("0b2e5f4c-7d1a-4e3b-9c8d-abcdef01234g", uuid), "parse: not hex");
+
+  // Ordering matches the text form, so prefixes can be searched.
+  Uuid low;
+  Uuid high;
+  Uuid::parse ("0b2e5f4c-7d1a-4e3b-9c8d-abcdef012345", low);
+  Uuid::parse ("0b2e5f4d-0000-0000-0000-000000000000", high);
+  t.ok (low < high,                                                 "operator<: by text");
+  t.ok (low != high,                                                "operator!=");
+
+  Uuid floor;
+  t.ok (Uuid::floor ("0b2e5f4c-7", floor),                          "floor: prefix with dash");
+  t.ok (! (low < floor) && low.startsWith ("0b2e5f4c-7"),           "floor: at or below a match");
+  t.notok (high.startsWith ("0b2e5f4c"),                            "startsWith: no match");
+
+  // Equal values hash equally.
+  Uuid copy;
+  Uuid::parse (low.str (), copy);
+  t.ok (copy == low && copy.hash () == low.hash (),                  "hash: equal values");
+
+  std::unordered_set <Uuid> set {low, high, copy};
+  t.is (set.size (), (size_t) 2,                                    "unordered_set: 2 distinct");
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
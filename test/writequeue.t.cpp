@@ -0,0 +1,183 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2017, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// http://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <unistd.h>
+#include <Executor.h>
+#include <WriteQueue.h>
+#include <Uuid.h>
+#include <shared.h>
+#include <test.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Logs every write, and fails any that completes the task given.
+class LogExecutor : public Executor
+{
+public:
+  int run (const std::string&, const std::vector <std::string>&) override
+  {
+    return 0;
+  }
+
+  int runPty (const std::string&, const std::vector <std::string>&, unsigned short, unsigned short, std::string&, std::string::size_type) override
+  {
+    return 0;
+  }
+
+  int capture (const std::string&, const std::vector <std::string>&, std::string& output, int) override
+  {
+    output = "";
+    return 0;
+  }
+
+  int collect (const std::string&, const std::vector <std::string>& args, std::string& output, std::string& errors) override
+  {
+    // Without the leading rc overrides.
+    auto command = join (" ", std::vector <std::string> (args.begin () + 3, args.end ()));
+    output = "";
+    errors = "";
+
+    std::lock_guard <std::mutex> lock (_mutex);
+    _commands.push_back (command);
+    return command == _failing + " done" ? 1 : 0;
+  }
+
+  int stream (const std::string&, const std::vector <std::string>&, std::function <bool (const std::string&)>) override
+  {
+    return 0;
+  }
+
+  bool ran (const std::string& command)
+  {
+    std::lock_guard <std::mutex> lock (_mutex);
+    return std::find (_commands.begin (), _commands.end (), command) != _commands.end ();
+  }
+
+  void clear ()
+  {
+    std::lock_guard <std::mutex> lock (_mutex);
+    _commands.clear ();
+  }
+
+  std::string _failing {};
+
+private:
+  std::vector <std::string> _commands {};
+  std::mutex                _mutex    {};
+};
+
+////////////////////////////////////////////////////////////////////////////////
+static std::string contents (const std::string& file)
+{
+  std::ifstream in (file, std::ios::binary);
+  return std::string ((std::istreambuf_iterator <char> (in)), std::istreambuf_iterator <char> ());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int main (int, char**)
+{
+  UnitTest t (14);
+
+  auto log = new LogExecutor ();
+  selectExecutor (std::unique_ptr <Executor> (log));
+
+  std::string journal = "writequeue.journal";
+  unlink (journal.c_str ());
+
+  Uuid one;
+  Uuid two;
+  Uuid three;
+  Uuid::parse ("a0000000-0000-0000-0000-000000000001", one);
+  Uuid::parse ("a0000000-0000-0000-0000-000000000002", two);
+  Uuid::parse ("a0000000-0000-0000-0000-000000000003", three);
+
+  {
+    WriteQueue writes;
+    writes.batchSize (10);
+
+    unsigned int recovered;
+    t.ok (writes.background (journal, recovered),           "background: new journal -> true");
+    t.is ((int) recovered, 0,                               "background: new journal -> nothing recovered");
+
+    // Repeatable actions are journaled, and buffered.
+    writes.add (one, {"modify", "reviewed:now"});
+    writes.add (two, {"done"});
+    t.ok (contents (journal).find (two.str () + " done\n") != std::string::npos,
+                                                            "add: done -> journaled");
+    t.ok (! log->ran (two.str () + " done"),                "add: done -> buffered");
+
+    // Anything else is written at once, after what came before, and is never
+    // journaled.
+    writes.add (three, {"modify", "+tag", "reviewed:now"});
+    t.ok (log->ran (one.str () + " modify reviewed:now") &&
+          log->ran (two.str () + " done"),                  "add: modify +tag -> earlier writes made first");
+    t.ok (log->ran (three.str () + " modify +tag reviewed:now"),
+                                                            "add: modify +tag -> written before returning");
+    t.ok (contents (journal).find ("+tag") == std::string::npos,
+                                                            "add: modify +tag -> not journaled");
+
+    writes.drain ();
+    t.is ((int) writes.succeeded (), 3,                     "drain: 3 writes succeeded");
+    t.is (contents (journal), "",                           "drain: journal emptied");
+  }
+
+  // An earlier session wrote '-1' for the first entry, crashed after the
+  // second, and while appending the third.
+  {
+    std::ofstream out (journal, std::ios::binary | std::ios::trunc);
+    out << "+1 " << one.str () << " modify\x1freviewed:now\n"
+        << "+2 " << two.str () << " done\n"
+        << "-1\n"
+        << "+3 " << three.str () << " del";
+  }
+
+  {
+    log->clear ();
+    log->_failing = two.str ();
+
+    WriteQueue writes;
+    unsigned int recovered;
+    t.ok (writes.background (journal, recovered),           "background: old journal -> true");
+    t.is ((int) recovered, 1,                               "background: old journal -> only the outstanding entry recovered");
+
+    writes.drain ();
+    t.ok (log->ran (two.str () + " done"),                  "recover: outstanding entry written");
+    t.is (writes.failures ().size (), (size_t) 1,           "recover: failed write reported");
+    t.is ((int) writes.succeeded (), 0,                     "recover: failed write not counted as succeeded");
+  }
+
+  unlink (journal.c_str ());
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////